@@ -0,0 +1,513 @@
+#include "evdev_source.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include "../../core/clock.h"
+#include "../../core/input_pipeline.h"
+#include "../../core/keycodes.h"
+
+namespace {
+
+constexpr int POLL_TIMEOUT_MS = 100;
+constexpr size_t READ_BATCH = 64;
+
+// Retry interval while a gamepad report waits for room in the queue
+constexpr int PENDING_RETRY_MS = 1;
+
+bool TestBit(const unsigned long* bits, unsigned int bit) {
+    constexpr unsigned int BITS_PER_LONG = sizeof(unsigned long) * 8;
+    return (bits[bit / BITS_PER_LONG] >> (bit % BITS_PER_LONG)) & 1UL;
+}
+
+// True for devices that can drive the pointer or type keys
+bool IsPointerOrKeyboard(int fd) {
+    unsigned long evBits[(EV_MAX + 1 + sizeof(unsigned long) * 8 - 1) / (sizeof(unsigned long) * 8)] = {0};
+    unsigned long relBits[(REL_MAX + 1 + sizeof(unsigned long) * 8 - 1) / (sizeof(unsigned long) * 8)] = {0};
+    unsigned long keyBits[(KEY_MAX + 1 + sizeof(unsigned long) * 8 - 1) / (sizeof(unsigned long) * 8)] = {0};
+
+    if (ioctl(fd, EVIOCGBIT(0, sizeof(evBits)), evBits) < 0)
+        return false;
+
+    if (TestBit(evBits, EV_REL) &&
+        ioctl(fd, EVIOCGBIT(EV_REL, sizeof(relBits)), relBits) >= 0 &&
+        TestBit(relBits, REL_X)) {
+        return true;
+    }
+
+    return TestBit(evBits, EV_KEY) &&
+           ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keyBits)), keyBits) >= 0 &&
+           TestBit(keyBits, KEY_A);
+}
+
+// Identity shared by the uinput and uhid devices we create
+bool IsLoopbackDevice(const input_id& id) {
+    return id.bustype == BUS_VIRTUAL && id.vendor == LOOPBACK_VENDOR_ID &&
+           id.product == LOOPBACK_PRODUCT_ID && id.version == LOOPBACK_VERSION;
+}
+
+// Sticks plus gamepad or joystick buttons; touchpads and tablets also
+// report ABS_X but have neither
+bool IsGamepad(int fd) {
+    unsigned long evBits[(EV_MAX + 1 + sizeof(unsigned long) * 8 - 1) / (sizeof(unsigned long) * 8)] = {0};
+    unsigned long absBits[(ABS_MAX + 1 + sizeof(unsigned long) * 8 - 1) / (sizeof(unsigned long) * 8)] = {0};
+    unsigned long keyBits[(KEY_MAX + 1 + sizeof(unsigned long) * 8 - 1) / (sizeof(unsigned long) * 8)] = {0};
+
+    if (ioctl(fd, EVIOCGBIT(0, sizeof(evBits)), evBits) < 0 ||
+        !TestBit(evBits, EV_ABS) || !TestBit(evBits, EV_KEY)) {
+        return false;
+    }
+
+    return ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(absBits)), absBits) >= 0 && TestBit(absBits, ABS_X) &&
+           ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keyBits)), keyBits) >= 0 &&
+           (TestBit(keyBits, BTN_GAMEPAD) || TestBit(keyBits, BTN_JOYSTICK));
+}
+
+// Whether the device reports a given relative axis
+bool HasRelAxis(int fd, unsigned int axis) {
+    unsigned long relBits[(REL_MAX + 1 + sizeof(unsigned long) * 8 - 1) / (sizeof(unsigned long) * 8)] = {0};
+    return ioctl(fd, EVIOCGBIT(EV_REL, sizeof(relBits)), relBits) >= 0 && TestBit(relBits, axis);
+}
+
+// Kernel timestamp of an event in nanoseconds
+uint64_t EventTimeNs(const input_event& event) {
+#ifdef input_event_sec
+    return static_cast<uint64_t>(event.input_event_sec) * 1000000000ull +
+           static_cast<uint64_t>(event.input_event_usec) * 1000ull;
+#else
+    return static_cast<uint64_t>(event.time.tv_sec) * 1000000000ull +
+           static_cast<uint64_t>(event.time.tv_usec) * 1000ull;
+#endif
+}
+
+uint8_t ButtonBitForCode(uint16_t code) {
+    switch (code) {
+        case BTN_LEFT:    return MOUSE_BUTTON_LEFT;
+        case BTN_RIGHT:   return MOUSE_BUTTON_RIGHT;
+        case BTN_MIDDLE:  return MOUSE_BUTTON_MIDDLE;
+        case BTN_SIDE:
+        case BTN_BACK:    return MOUSE_BUTTON_X1;
+        case BTN_EXTRA:
+        case BTN_FORWARD: return MOUSE_BUTTON_X2;
+        default:          return 0;
+    }
+}
+
+// Absolute axes read from gamepads and the report axis each one feeds
+struct GamepadAbsAxis {
+    uint16_t code;
+    uint8_t axis;
+};
+
+constexpr GamepadAbsAxis GAMEPAD_ABS_AXES[] = {
+    {ABS_X, GAMEPAD_AXIS_LX},
+    {ABS_Y, GAMEPAD_AXIS_LY},
+    {ABS_RX, GAMEPAD_AXIS_RX},
+    {ABS_RY, GAMEPAD_AXIS_RY},
+    {ABS_Z, GAMEPAD_AXIS_LT},
+    {ABS_RZ, GAMEPAD_AXIS_RT},
+    {ABS_BRAKE, GAMEPAD_AXIS_LT},
+    {ABS_GAS, GAMEPAD_AXIS_RT},
+    {ABS_HAT0X, GAMEPAD_AXIS_HAT},
+    {ABS_HAT0Y, GAMEPAD_AXIS_HAT},
+};
+
+uint8_t GamepadAxisForCode(uint16_t code) {
+    for (const GamepadAbsAxis& entry : GAMEPAD_ABS_AXES) {
+        if (entry.code == code)
+            return entry.axis;
+    }
+    return GAMEPAD_AXIS_COUNT;
+}
+
+// GamepadReport::buttons bit for BTN_JOYSTICK..BTN_THUMBR, or -1
+int GamepadButtonBit(uint16_t code) {
+    if (code >= BTN_GAMEPAD && code <= BTN_THUMBR)
+        return code - BTN_GAMEPAD;
+    if (code >= BTN_JOYSTICK && code < BTN_GAMEPAD)
+        return 16 + (code - BTN_JOYSTICK);
+    return -1;
+}
+
+}  // namespace
+
+EvdevSource::EvdevSource(std::vector<std::string> devicePaths)
+    : m_devicePaths(std::move(devicePaths)) {}
+
+EvdevSource::~EvdevSource() {
+    stop();
+}
+
+bool EvdevSource::openDevice(const std::string& path, bool autodetected) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        if (!autodetected)
+            std::cerr << "Failed to open " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Never capture our own loopback devices; everything they emit is ours,
+    // so filtering by device identity drops injected events and nothing else
+    input_id id{};
+    if (ioctl(fd, EVIOCGID, &id) == 0 && IsLoopbackDevice(id)) {
+        ::close(fd);
+        return false;
+    }
+
+    bool gamepad = IsGamepad(fd);
+    if (autodetected && !gamepad && !IsPointerOrKeyboard(fd)) {
+        ::close(fd);
+        return false;
+    }
+
+    // Kernel timestamps on the same clock as MonotonicNanos()
+    int clockId = CLOCK_MONOTONIC;
+    bool monotonicTimestamps = ioctl(fd, EVIOCSCLOCKID, &clockId) == 0;
+
+    Device device;
+    device.fd = fd;
+    device.path = path;
+    device.id = static_cast<uint16_t>(m_devices.size() + 1);
+    device.gamepadState.device = device.id;
+    device.monotonicTimestamps = monotonicTimestamps;
+
+    // High-resolution wheels report both axes; take the finer one only
+#ifdef REL_WHEEL_HI_RES
+    device.hiResWheel = HasRelAxis(fd, REL_WHEEL_HI_RES);
+    device.hiResHWheel = HasRelAxis(fd, REL_HWHEEL_HI_RES);
+#endif
+
+    // Axis ranges and the current pad state, so the first frame is complete
+    device.gamepad = gamepad;
+    if (gamepad)
+        syncGamepad(device);
+
+    m_devices.push_back(device);
+    return true;
+}
+
+bool EvdevSource::start(InputPipeline& pipeline) {
+    m_pipeline = &pipeline;
+    m_stop = false;
+
+    if (!m_devicePaths.empty()) {
+        for (const std::string& path : m_devicePaths)
+            openDevice(path, false);
+    } else if (DIR* dir = opendir("/dev/input")) {
+        std::vector<std::string> candidates;
+        while (dirent* entry = readdir(dir)) {
+            if (strncmp(entry->d_name, "event", 5) == 0)
+                candidates.push_back(std::string("/dev/input/") + entry->d_name);
+        }
+        closedir(dir);
+
+        std::sort(candidates.begin(), candidates.end());
+        for (const std::string& path : candidates)
+            openDevice(path, true);
+    }
+
+    if (m_devices.empty()) {
+        std::cerr << "No evdev input devices could be opened" << std::endl;
+        return false;
+    }
+
+    for (const Device& device : m_devices)
+        std::cout << "Capturing " << device.path << std::endl;
+
+    m_thread = std::thread(&EvdevSource::run, this);
+    return true;
+}
+
+void EvdevSource::stop() {
+    m_stop = true;
+    if (m_thread.joinable())
+        m_thread.join();
+
+    for (Device& device : m_devices) {
+        if (device.fd >= 0)
+            ::close(device.fd);
+    }
+    m_devices.clear();
+}
+
+void EvdevSource::run() {
+    std::vector<pollfd> fds(m_devices.size());
+    for (size_t i = 0; i < m_devices.size(); i++) {
+        fds[i].fd = m_devices[i].fd;
+        fds[i].events = POLLIN;
+    }
+
+    input_event events[READ_BATCH];
+
+    while (!m_stop && m_pipeline->running) {
+        bool pending = std::any_of(m_devices.begin(), m_devices.end(),
+                                   [](const Device& device) { return device.gamepadPending; });
+        int ready = poll(fds.data(), fds.size(), pending ? PENDING_RETRY_MS : POLL_TIMEOUT_MS);
+
+        // Older pad state goes out before anything read below
+        for (Device& device : m_devices) {
+            if (device.gamepadPending)
+                pushGamepad(device);
+        }
+
+        if (ready <= 0)
+            continue;
+
+        for (size_t i = 0; i < fds.size(); i++) {
+            if (!(fds[i].revents & POLLIN))
+                continue;
+
+            ssize_t bytes = read(fds[i].fd, events, sizeof(events));
+            if (bytes <= 0)
+                continue;
+
+            size_t count = static_cast<size_t>(bytes) / sizeof(input_event);
+            for (size_t j = 0; j < count; j++)
+                handleEvent(m_devices[i], events[j]);
+        }
+    }
+}
+
+void EvdevSource::handleEvent(Device& device, const input_event& event) {
+    if (device.dropping) {
+        if (event.type == EV_SYN && event.code == SYN_REPORT) {
+            device.dropping = false;
+            resync(device);
+            flush(device, device.monotonicTimestamps ? EventTimeNs(event) : MonotonicNanos());
+        }
+        return;
+    }
+
+    switch (event.type) {
+        case EV_REL:
+            switch (event.code) {
+                case REL_X:
+                    device.dx += event.value;
+                    break;
+                case REL_Y:
+                    device.dy += event.value;
+                    break;
+                case REL_WHEEL:
+                    if (device.hiResWheel) return;
+                    device.wheel += event.value * WHEEL_UNITS_PER_NOTCH;
+                    break;
+                case REL_HWHEEL:
+                    if (device.hiResHWheel) return;
+                    device.hwheel += event.value * WHEEL_UNITS_PER_NOTCH;
+                    break;
+#ifdef REL_WHEEL_HI_RES
+                case REL_WHEEL_HI_RES:
+                    device.wheel += event.value;
+                    break;
+                case REL_HWHEEL_HI_RES:
+                    device.hwheel += event.value;
+                    break;
+#endif
+                default:
+                    return;
+            }
+            device.mouseDirty = true;
+            break;
+
+        case EV_ABS:
+            if (!device.gamepad || GamepadAxisForCode(event.code) == GAMEPAD_AXIS_COUNT)
+                break;
+            setGamepadAxis(device, event.code, event.value);
+            device.gamepadDirty = true;
+            break;
+
+        case EV_KEY: {
+            // Ignore autorepeat, the injector sees the held state instead
+            if (event.value == 2)
+                break;
+            bool down = event.value != 0;
+
+            int gamepadBit = device.gamepad ? GamepadButtonBit(event.code) : -1;
+            if (gamepadBit >= 0) {
+                uint32_t bit = 1u << gamepadBit;
+                uint32_t& buttons = device.gamepadState.buttons;
+                buttons = down ? (buttons | bit) : (buttons & ~bit);
+                device.gamepadDirty = true;
+                break;
+            }
+
+            if (uint8_t button = ButtonBitForCode(event.code)) {
+                device.mouseButtons = down ? (device.mouseButtons | button) : (device.mouseButtons & ~button);
+                m_mouseButtons = down ? (m_mouseButtons | button) : (m_mouseButtons & ~button);
+                device.mouseDirty = true;
+                break;
+            }
+
+            uint8_t usage = EvdevToHidUsage(event.code);
+            if (usage == HID_USAGE_NONE)
+                break;
+
+            // Program control keys
+            if (down && HandleControlKey(*m_pipeline, usage))
+                break;
+
+            device.keys.assign(usage, down);
+            if (m_keyState.test(usage) != down) {
+                m_keyState.assign(usage, down);
+                device.keyboardDirty = true;
+            }
+            break;
+        }
+
+        case EV_SYN:
+            if (event.code == SYN_REPORT) {
+                flush(device, device.monotonicTimestamps ? EventTimeNs(event) : MonotonicNanos());
+            } else if (event.code == SYN_DROPPED) {
+                // Kernel buffer overran: discard the partial frame and
+                // everything up to the next SYN_REPORT, then resync
+                device.dx = device.dy = device.wheel = device.hwheel = 0;
+                device.mouseDirty = device.keyboardDirty = device.gamepadDirty = false;
+                device.dropping = true;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void EvdevSource::flush(Device& device, uint64_t timestamp) {
+    bool capture = !m_pipeline->blockFeedback.load(std::memory_order_acquire);
+
+    if (device.mouseDirty && capture) {
+        MouseReport report;
+        report.buttons = m_mouseButtons;
+        report.x = device.dx;
+        report.y = device.dy;
+        report.wheel = device.wheel;
+        report.hwheel = device.hwheel;
+        report.timestamp = timestamp;
+        report.device = device.id;
+        m_pipeline->pushMouse(report);
+    }
+
+    if (device.keyboardDirty && capture) {
+        KeyboardReport report;
+        report.timestamp = timestamp;
+        report.device = device.id;
+
+        // Fill modifiers and the active keys
+        report.setHeldKeys(m_keyState);
+
+        m_pipeline->pushKeyboard(report);
+    }
+
+    if (device.gamepadDirty && capture) {
+        device.gamepadState.timestamp = timestamp;
+        pushGamepad(device);
+    }
+
+    device.dx = device.dy = device.wheel = device.hwheel = 0;
+    device.mouseDirty = device.keyboardDirty = device.gamepadDirty = false;
+}
+
+void EvdevSource::setGamepadAxis(Device& device, uint16_t code, int32_t value) {
+    GamepadReport& state = device.gamepadState;
+
+    if (code == ABS_HAT0X || code == ABS_HAT0Y) {
+        int8_t direction = value < 0 ? -1 : (value > 0 ? 1 : 0);
+        (code == ABS_HAT0X ? device.hatX : device.hatY) = direction;
+        state.hat = GamepadHatFromAxes(device.hatX, device.hatY);
+        return;
+    }
+
+    uint8_t axis = GamepadAxisForCode(code);
+    int64_t minimum = device.absMin[axis];
+    int64_t maximum = device.absMax[axis];
+    if (maximum <= minimum)
+        return;
+
+    // Rescale the device range onto the full 16-bit report range
+    int64_t clamped = std::clamp<int64_t>(value, minimum, maximum);
+    int64_t scaled = (clamped - minimum) * 65535 / (maximum - minimum);
+    if (axis < GAMEPAD_AXIS_LT)
+        state.sticks[axis] = static_cast<int16_t>(scaled - 32768);
+    else
+        state.triggers[axis - GAMEPAD_AXIS_LT] = static_cast<uint16_t>(scaled);
+}
+
+void EvdevSource::syncGamepad(Device& device) {
+    unsigned long absBits[(ABS_MAX + 1 + sizeof(unsigned long) * 8 - 1) / (sizeof(unsigned long) * 8)] = {0};
+    unsigned long keyBits[(KEY_MAX + 1 + sizeof(unsigned long) * 8 - 1) / (sizeof(unsigned long) * 8)] = {0};
+
+    ioctl(device.fd, EVIOCGBIT(EV_ABS, sizeof(absBits)), absBits);
+    for (const GamepadAbsAxis& entry : GAMEPAD_ABS_AXES) {
+        input_absinfo info{};
+        if (!TestBit(absBits, entry.code) || ioctl(device.fd, EVIOCGABS(entry.code), &info) < 0)
+            continue;
+        if (entry.axis < GAMEPAD_AXIS_HAT) {
+            device.absMin[entry.axis] = info.minimum;
+            device.absMax[entry.axis] = info.maximum;
+        }
+        setGamepadAxis(device, entry.code, info.value);
+    }
+
+    if (ioctl(device.fd, EVIOCGKEY(sizeof(keyBits)), keyBits) >= 0) {
+        uint32_t buttons = 0;
+        for (uint16_t code = BTN_JOYSTICK; code <= BTN_THUMBR; code++) {
+            int bit = GamepadButtonBit(code);
+            if (bit >= 0 && TestBit(keyBits, code))
+                buttons |= 1u << bit;
+        }
+        device.gamepadState.buttons = buttons;
+    }
+}
+
+void EvdevSource::resync(Device& device) {
+    // Pad reports carry full state, so re-read it whole
+    if (device.gamepad) {
+        syncGamepad(device);
+        device.gamepadDirty = true;
+    }
+
+    unsigned long keyBits[(KEY_MAX + 1 + sizeof(unsigned long) * 8 - 1) / (sizeof(unsigned long) * 8)] = {0};
+    if (ioctl(device.fd, EVIOCGKEY(sizeof(keyBits)), keyBits) < 0)
+        return;
+
+    // Presses and releases lost in the dropped span become state changes
+    for (uint16_t code = 0; code <= KEY_MAX; code++) {
+        bool down = TestBit(keyBits, code);
+        if (device.gamepad && GamepadButtonBit(code) >= 0)
+            continue;
+
+        if (uint8_t button = ButtonBitForCode(code)) {
+            if (((device.mouseButtons & button) != 0) == down)
+                continue;
+            device.mouseButtons = down ? (device.mouseButtons | button) : (device.mouseButtons & ~button);
+            m_mouseButtons = down ? (m_mouseButtons | button) : (m_mouseButtons & ~button);
+            device.mouseDirty = true;
+            continue;
+        }
+
+        // Control keys act on a press, which a resync has not seen
+        uint8_t usage = EvdevToHidUsage(code);
+        if (usage == HID_USAGE_NONE || IsControlKey(usage) || device.keys.test(usage) == down)
+            continue;
+        device.keys.assign(usage, down);
+        if (m_keyState.test(usage) != down) {
+            m_keyState.assign(usage, down);
+            device.keyboardDirty = true;
+        }
+    }
+}
+
+void EvdevSource::pushGamepad(Device& device) {
+    // A full ring keeps the state pending; run() retries it shortly
+    GamepadReport report = device.gamepadState;
+    device.gamepadPending = !m_pipeline->pushGamepad(report);
+}
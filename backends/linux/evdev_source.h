@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../core/hid_reports.h"
+#include "../../core/input_backend.h"
+
+struct input_event;
+
+// Reads mice, keyboards and gamepads from /dev/input/event* on a dedicated
+// thread. With no explicit paths every pointer/keyboard/gamepad device is
+// opened, skipping our own loopback devices so injected events are not
+// captured again.
+class EvdevSource : public InputSource {
+public:
+    explicit EvdevSource(std::vector<std::string> devicePaths = {});
+    ~EvdevSource() override;
+
+    const char* name() const override { return "evdev"; }
+    bool start(InputPipeline& pipeline) override;
+    void stop() override;
+
+private:
+    struct Device {
+        int fd = -1;
+        std::string path;
+        uint16_t id = DEVICE_UNKNOWN;      // Report device ID, from 1 in open order
+        int32_t dx = 0;
+        int32_t dy = 0;
+        int32_t wheel = 0;
+        int32_t hwheel = 0;
+        bool mouseDirty = false;
+        bool keyboardDirty = false;
+        bool monotonicTimestamps = false;  // Kernel stamps use CLOCK_MONOTONIC
+        bool hiResWheel = false;           // Reports REL_WHEEL_HI_RES
+        bool hiResHWheel = false;          // Reports REL_HWHEEL_HI_RES
+
+        // After SYN_DROPPED events are skipped up to the next SYN_REPORT,
+        // then buttons and keys held here are compared with the kernel's
+        bool dropping = false;
+        uint8_t mouseButtons = 0;
+        KeyBitmap keys;
+
+        // Gamepads keep their full state here and push it on every frame
+        bool gamepad = false;
+        bool gamepadDirty = false;
+        bool gamepadPending = false;  // Last report found the queue full
+        int8_t hatX = 0;
+        int8_t hatY = 0;
+        int32_t absMin[GAMEPAD_AXIS_HAT] = {};
+        int32_t absMax[GAMEPAD_AXIS_HAT] = {};
+        GamepadReport gamepadState;
+    };
+
+    bool openDevice(const std::string& path, bool autodetected);
+    void run();
+    void handleEvent(Device& device, const input_event& event);
+    void flush(Device& device, uint64_t timestamp);
+    void setGamepadAxis(Device& device, uint16_t code, int32_t value);
+    void syncGamepad(Device& device);
+    void resync(Device& device);
+    void pushGamepad(Device& device);
+
+    std::vector<std::string> m_devicePaths;
+    std::vector<Device> m_devices;
+    InputPipeline* m_pipeline = nullptr;
+    std::thread m_thread;
+    std::atomic<bool> m_stop{false};
+
+    // Shared across devices, only touched by the reader thread
+    uint8_t m_mouseButtons = 0;
+    KeyBitmap m_keyState;
+};
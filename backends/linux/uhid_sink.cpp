@@ -0,0 +1,159 @@
+#include "uhid_sink.h"
+
+#include <fcntl.h>
+#include <linux/uhid.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include "../../core/clock.h"
+
+namespace {
+
+// Wakeup interval of the event thread, so close() is prompt
+constexpr int POLL_TIMEOUT_MS = 100;
+
+// How long open() waits for the kernel to start the device
+constexpr uint64_t START_TIMEOUT_NS = 2000000000;
+
+bool WriteEvent(int fd, const uhid_event& event) {
+    ssize_t written = write(fd, &event, sizeof(event));
+    return written == static_cast<ssize_t>(sizeof(event));
+}
+
+}  // namespace
+
+UhidSink::~UhidSink() {
+    close();
+}
+
+bool UhidSink::open() {
+    // Non-blocking so readEvents() can read until the queue is empty
+    m_fd = ::open("/dev/uhid", O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0) {
+        std::cerr << "Failed to open /dev/uhid: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    uhid_event event{};
+    event.type = UHID_CREATE2;
+    uhid_create2_req& create = event.u.create2;
+    strncpy(reinterpret_cast<char*>(create.name), "HID Loopback", sizeof(create.name) - 1);
+    create.rd_size = sizeof(HID_REPORT_DESCRIPTOR);
+    create.bus = BUS_VIRTUAL;
+    create.vendor = LOOPBACK_VENDOR_ID;
+    create.product = LOOPBACK_PRODUCT_ID;
+    create.version = LOOPBACK_VERSION;
+    memcpy(create.rd_data, HID_REPORT_DESCRIPTOR, sizeof(HID_REPORT_DESCRIPTOR));
+
+    if (!WriteEvent(m_fd, event)) {
+        std::cerr << "Failed to create uhid device: " << strerror(errno) << std::endl;
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    // uhid rejects input until a HID driver has started the device
+    m_started = false;
+    uint64_t deadlineNs = MonotonicNanos() + START_TIMEOUT_NS;
+    pollfd fd{m_fd, POLLIN, 0};
+    while (!m_started && MonotonicNanos() < deadlineNs) {
+        if (poll(&fd, 1, POLL_TIMEOUT_MS) > 0)
+            readEvents();
+    }
+    if (!m_started) {
+        std::cerr << "uhid device was not started by the kernel" << std::endl;
+        close();
+        return false;
+    }
+
+    resetState();
+    m_stop = false;
+    m_eventThread = std::thread(&UhidSink::serviceEvents, this);
+    return true;
+}
+
+void UhidSink::close() {
+    m_stop = true;
+    if (m_eventThread.joinable())
+        m_eventThread.join();
+
+    if (m_fd >= 0) {
+        uhid_event event{};
+        event.type = UHID_DESTROY;
+        WriteEvent(m_fd, event);
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    m_started = false;
+}
+
+void UhidSink::serviceEvents() {
+    pollfd fd{m_fd, POLLIN, 0};
+    while (!m_stop.load(std::memory_order_relaxed)) {
+        if (poll(&fd, 1, POLL_TIMEOUT_MS) > 0)
+            readEvents();
+    }
+}
+
+void UhidSink::readEvents() {
+    uhid_event event;
+    while (read(m_fd, &event, sizeof(event)) > 0) {
+        uhid_event reply{};
+        switch (event.type) {
+            case UHID_START:
+                m_started = true;
+                continue;
+            case UHID_STOP:
+                m_started = false;
+                continue;
+            // Nothing but input reports is supported; refuse requests at
+            // once instead of leaving the caller to the kernel's timeout
+            case UHID_GET_REPORT:
+                reply.type = UHID_GET_REPORT_REPLY;
+                reply.u.get_report_reply.id = event.u.get_report.id;
+                reply.u.get_report_reply.err = EIO;
+                break;
+            case UHID_SET_REPORT:
+                reply.type = UHID_SET_REPORT_REPLY;
+                reply.u.set_report_reply.id = event.u.set_report.id;
+                reply.u.set_report_reply.err = EIO;
+                break;
+            default:
+                // UHID_OPEN, UHID_CLOSE, UHID_OUTPUT (LEDs)
+                continue;
+        }
+        WriteEvent(m_fd, reply);
+    }
+}
+
+bool UhidSink::writeReports(HidWireReport* reports, size_t count) {
+    // Stopped by the kernel, e.g. the driver was unbound; the short count
+    // goes back to the pipeline
+    if (m_fd < 0 || !m_started.load(std::memory_order_relaxed))
+        return false;
+
+    // uhid takes one event per write, so the batch goes out as one writev
+    // with a short UHID_INPUT2 record per report. The record header goes in
+    // the room left before each report, which is then written in place.
+    static_assert(HID_TRANSPORT_HEADER_ROOM == sizeof(uint32_t) + sizeof(uint16_t),
+                  "UHID_INPUT2 header is the event type and payload size");
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t type = UHID_INPUT2;
+        uint16_t size = reports[i].size;
+        uint8_t* header = reports[i].header;
+        memcpy(header, &type, sizeof(type));
+        memcpy(header + sizeof(type), &size, sizeof(size));
+
+        m_iov[i].iov_base = header;
+        m_iov[i].iov_len = HID_TRANSPORT_HEADER_ROOM + size;
+        total += HID_TRANSPORT_HEADER_ROOM + size;
+    }
+
+    ssize_t written = writev(m_fd, m_iov, static_cast<int>(count));
+    return written == static_cast<ssize_t>(total);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <sys/uio.h>
+
+#include <atomic>
+#include <thread>
+
+#include "../../core/hid_report_sink.h"
+
+// Registers one composite HID device through /dev/uhid with
+// LOOPBACK_VENDOR_ID/LOOPBACK_PRODUCT_ID and HID_REPORT_DESCRIPTOR, so
+// consumers see a keyboard, mouse and gamepad behind a real HID driver
+// rather than synthetic uinput events. open() returns once the kernel has
+// started the device; from then on a thread of its own reads what the kernel
+// sends back and answers GET_REPORT and SET_REPORT requests with an error.
+class UhidSink : public HidReportSink {
+public:
+    ~UhidSink() override;
+
+    const char* name() const override { return "uhid"; }
+    bool open() override;
+    void close() override;
+
+protected:
+    bool writeReports(HidWireReport* reports, size_t count) override;
+
+private:
+    void serviceEvents();
+    // Reads every pending kernel event and answers the ones that need a reply
+    void readEvents();
+
+    int m_fd = -1;
+    iovec m_iov[MAX_BATCH];
+
+    std::thread m_eventThread;
+    std::atomic<bool> m_stop{false};
+    std::atomic<bool> m_started{false};
+};
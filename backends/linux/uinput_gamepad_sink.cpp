@@ -0,0 +1,145 @@
+#include "uinput_gamepad_sink.h"
+
+#include <fcntl.h>
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include "../../core/hid_reports.h"
+
+namespace {
+
+// ABS code for each GAMEPAD_AXIS_* below the hat
+constexpr uint16_t AXIS_CODES[] = {ABS_X, ABS_Y, ABS_RX, ABS_RY, ABS_Z, ABS_RZ};
+
+// Inverse of the evdev source mapping: bits 0-14 from BTN_GAMEPAD, 16-31
+// from BTN_JOYSTICK
+uint16_t ButtonCode(uint8_t bit) {
+    if (bit < 15) return BTN_GAMEPAD + bit;
+    if (bit >= 16 && bit < GAMEPAD_BUTTON_COUNT) return BTN_JOYSTICK + (bit - 16);
+    return 0;
+}
+
+void Append(input_event* buffer, size_t& count, uint16_t type, uint16_t code, int32_t value) {
+    input_event& event = buffer[count++];
+    memset(&event, 0, sizeof(event));
+    event.type = type;
+    event.code = code;
+    event.value = value;
+}
+
+bool SetupAxis(int fd, uint16_t code, int32_t minimum, int32_t maximum) {
+    uinput_abs_setup setup{};
+    setup.code = code;
+    setup.absinfo.minimum = minimum;
+    setup.absinfo.maximum = maximum;
+    return ioctl(fd, UI_SET_ABSBIT, code) >= 0 && ioctl(fd, UI_ABS_SETUP, &setup) >= 0;
+}
+
+}  // namespace
+
+UinputGamepadSink::~UinputGamepadSink() {
+    close();
+}
+
+bool UinputGamepadSink::open() {
+    m_fd = ::open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0) {
+        std::cerr << "Failed to open /dev/uinput: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Sticks span the report range, triggers are unsigned, the hat is digital
+    ioctl(m_fd, UI_SET_EVBIT, EV_SYN);
+    ioctl(m_fd, UI_SET_EVBIT, EV_ABS);
+    bool axesReady = SetupAxis(m_fd, ABS_X, -32768, 32767) && SetupAxis(m_fd, ABS_Y, -32768, 32767) &&
+                     SetupAxis(m_fd, ABS_RX, -32768, 32767) && SetupAxis(m_fd, ABS_RY, -32768, 32767) &&
+                     SetupAxis(m_fd, ABS_Z, 0, 65535) && SetupAxis(m_fd, ABS_RZ, 0, 65535) &&
+                     SetupAxis(m_fd, ABS_HAT0X, -1, 1) && SetupAxis(m_fd, ABS_HAT0Y, -1, 1);
+
+    ioctl(m_fd, UI_SET_EVBIT, EV_KEY);
+    for (uint8_t bit = 0; bit < GAMEPAD_BUTTON_COUNT; bit++) {
+        if (uint16_t code = ButtonCode(bit))
+            ioctl(m_fd, UI_SET_KEYBIT, code);
+    }
+
+    // Same loopback IDs as the pointer device, so capture skips it too
+    uinput_setup setup{};
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.vendor = LOOPBACK_VENDOR_ID;
+    setup.id.product = LOOPBACK_PRODUCT_ID;
+    setup.id.version = LOOPBACK_VERSION;
+    strncpy(setup.name, "HID Loopback Gamepad", UINPUT_MAX_NAME_SIZE - 1);
+
+    if (!axesReady || ioctl(m_fd, UI_DEV_SETUP, &setup) < 0 || ioctl(m_fd, UI_DEV_CREATE) < 0) {
+        std::cerr << "Failed to create uinput gamepad: " << strerror(errno) << std::endl;
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+void UinputGamepadSink::close() {
+    if (m_fd >= 0) {
+        ioctl(m_fd, UI_DEV_DESTROY);
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+size_t UinputGamepadSink::send(const InputEvent* events, size_t count) {
+    size_t sent = 0;
+
+    while (sent < count) {
+        size_t batchStart = sent;
+        size_t eventCount = 0;
+
+        for (size_t batched = 0; sent < count && batched < MAX_BATCH; sent++, batched++) {
+            const InputEvent& event = events[sent];
+
+            switch (event.type) {
+                case InputEventType::GAMEPAD_AXIS:
+                    if (event.code == GAMEPAD_AXIS_HAT) {
+                        int x = 0, y = 0;
+                        GamepadHatToAxes(static_cast<uint8_t>(event.value), x, y);
+                        Append(m_eventBuffer, eventCount, EV_ABS, ABS_HAT0X, x);
+                        Append(m_eventBuffer, eventCount, EV_ABS, ABS_HAT0Y, y);
+                    } else if (event.code < GAMEPAD_AXIS_HAT) {
+                        Append(m_eventBuffer, eventCount, EV_ABS, AXIS_CODES[event.code], event.value);
+                    }
+                    break;
+                case InputEventType::GAMEPAD_BUTTON:
+                    if (uint16_t code = ButtonCode(event.code))
+                        Append(m_eventBuffer, eventCount, EV_KEY, code, event.value);
+                    break;
+                default:
+                    continue;
+            }
+
+            // Frame one pad report's events together so sticks move as one sample
+            bool lastOfReport = event.endOfReport || sent + 1 == count || batched + 1 == MAX_BATCH;
+            if (lastOfReport)
+                Append(m_eventBuffer, eventCount, EV_SYN, SYN_REPORT, 0);
+        }
+
+        // Close a frame cut short by a skipped trailing event
+        if (eventCount > 0 && m_eventBuffer[eventCount - 1].type != EV_SYN)
+            Append(m_eventBuffer, eventCount, EV_SYN, SYN_REPORT, 0);
+
+        if (eventCount > 0 && m_fd >= 0) {
+            uint64_t writeStart = MonotonicNanos();
+            ssize_t written = write(m_fd, m_eventBuffer, eventCount * sizeof(input_event));
+            recordWrite(sent - batchStart, writeStart);
+            if (written < 0)
+                return batchStart;
+        }
+    }
+
+    return count;
+}
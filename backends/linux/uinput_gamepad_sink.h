@@ -0,0 +1,26 @@
+#pragma once
+
+#include <linux/input.h>
+
+#include "../../core/input_backend.h"
+
+// Injects gamepad events through a second virtual /dev/uinput device with
+// two sticks, two triggers, a hat and 31 buttons. Mouse and keyboard events
+// are ignored; pair it with UinputSink through a RoutingSink.
+class UinputGamepadSink : public InputSink {
+public:
+    static constexpr size_t MAX_BATCH = MAX_INJECT_BATCH;
+
+    ~UinputGamepadSink() override;
+
+    const char* name() const override { return "uinput-gamepad"; }
+    bool open() override;
+    void close() override;
+    size_t send(const InputEvent* events, size_t count) override;
+
+private:
+    int m_fd = -1;
+
+    // A hat event expands to two axes, plus SYN at each report boundary
+    input_event m_eventBuffer[MAX_BATCH * 3];
+};
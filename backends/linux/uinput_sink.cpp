@@ -0,0 +1,206 @@
+#include "uinput_sink.h"
+
+#include <fcntl.h>
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include "../../core/hid_reports.h"
+#include "../../core/keycodes.h"
+
+namespace {
+
+// Button bit -> evdev code; device setup and the event templates below are
+// generated from this table
+struct ButtonDescriptor {
+    uint8_t button;
+    uint16_t code;
+};
+
+constexpr ButtonDescriptor BUTTON_DESCRIPTORS[] = {
+    {MOUSE_BUTTON_LEFT, BTN_LEFT},
+    {MOUSE_BUTTON_RIGHT, BTN_RIGHT},
+    {MOUSE_BUTTON_MIDDLE, BTN_MIDDLE},
+    {MOUSE_BUTTON_X1, BTN_SIDE},
+    {MOUSE_BUTTON_X2, BTN_EXTRA},
+};
+
+static_assert(sizeof(BUTTON_DESCRIPTORS) / sizeof(BUTTON_DESCRIPTORS[0]) == MOUSE_BUTTON_COUNT);
+
+constexpr input_event MakeEvent(uint16_t type, uint16_t code, int32_t value) {
+    input_event event{};
+    event.type = type;
+    event.code = code;
+    event.value = value;
+    return event;
+}
+
+constexpr input_event SYN_EVENT = MakeEvent(EV_SYN, SYN_REPORT, 0);
+
+// Complete evdev event per button bit and direction, copied as is
+struct ButtonEventTable {
+    input_event events[MOUSE_BUTTON_COUNT][2];
+};
+
+constexpr ButtonEventTable MakeButtonEventTable() {
+    ButtonEventTable table{};
+    for (const ButtonDescriptor& descriptor : BUTTON_DESCRIPTORS) {
+        unsigned bit = 0;
+        while (!((descriptor.button >> bit) & 1))
+            bit++;
+        table.events[bit][0] = MakeEvent(EV_KEY, descriptor.code, 0);
+        table.events[bit][1] = MakeEvent(EV_KEY, descriptor.code, 1);
+    }
+    return table;
+}
+
+constexpr ButtonEventTable BUTTON_EVENTS = MakeButtonEventTable();
+
+#ifdef REL_WHEEL_HI_RES
+constexpr uint16_t WHEEL_HI_RES_AXIS = REL_WHEEL_HI_RES;
+constexpr uint16_t HWHEEL_HI_RES_AXIS = REL_HWHEEL_HI_RES;
+#else
+constexpr uint16_t WHEEL_HI_RES_AXIS = 0;  // Headers predate high-resolution wheels
+constexpr uint16_t HWHEEL_HI_RES_AXIS = 0;
+#endif
+
+// Events with a runtime value are built in place; copying a MakeEvent
+// temporary reloads its narrow field stores as one word and stalls
+void Append(input_event* buffer, size_t& count, uint16_t type, uint16_t code, int32_t value) {
+    input_event& event = buffer[count++];
+    memset(&event, 0, sizeof(event));
+    event.type = type;
+    event.code = code;
+    event.value = value;
+}
+
+}  // namespace
+
+UinputSink::~UinputSink() {
+    close();
+}
+
+bool UinputSink::open() {
+    m_fd = ::open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0) {
+        std::cerr << "Failed to open /dev/uinput: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Relative pointer with five buttons and both wheel axes
+    ioctl(m_fd, UI_SET_EVBIT, EV_SYN);
+    ioctl(m_fd, UI_SET_EVBIT, EV_REL);
+    ioctl(m_fd, UI_SET_RELBIT, REL_X);
+    ioctl(m_fd, UI_SET_RELBIT, REL_Y);
+    ioctl(m_fd, UI_SET_RELBIT, REL_WHEEL);
+    ioctl(m_fd, UI_SET_RELBIT, REL_HWHEEL);
+#ifdef REL_WHEEL_HI_RES
+    ioctl(m_fd, UI_SET_RELBIT, REL_WHEEL_HI_RES);
+    ioctl(m_fd, UI_SET_RELBIT, REL_HWHEEL_HI_RES);
+#endif
+
+    ioctl(m_fd, UI_SET_EVBIT, EV_KEY);
+    for (const ButtonDescriptor& descriptor : BUTTON_DESCRIPTORS)
+        ioctl(m_fd, UI_SET_KEYBIT, descriptor.code);
+
+    // Every key the HID usage table can express
+    for (int usage = 0; usage < 256; usage++) {
+        if (uint16_t code = HidUsageToEvdev(static_cast<uint8_t>(usage)))
+            ioctl(m_fd, UI_SET_KEYBIT, code);
+    }
+
+    uinput_setup setup{};
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.vendor = LOOPBACK_VENDOR_ID;
+    setup.id.product = LOOPBACK_PRODUCT_ID;
+    setup.id.version = LOOPBACK_VERSION;
+    strncpy(setup.name, "HID Loopback", UINPUT_MAX_NAME_SIZE - 1);
+
+    if (ioctl(m_fd, UI_DEV_SETUP, &setup) < 0 || ioctl(m_fd, UI_DEV_CREATE) < 0) {
+        std::cerr << "Failed to create uinput device: " << strerror(errno) << std::endl;
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+void UinputSink::close() {
+    if (m_fd >= 0) {
+        ioctl(m_fd, UI_DEV_DESTROY);
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+void UinputSink::appendWheel(size_t& eventCount, uint16_t axis, uint16_t hiResAxis,
+                             int32_t& remainder, int32_t value) {
+    if (hiResAxis != 0)
+        Append(m_eventBuffer, eventCount, EV_REL, hiResAxis, value);
+
+    // Whole detents only, carrying the fraction to the next event
+    remainder += value;
+    int32_t notches = remainder / WHEEL_UNITS_PER_NOTCH;
+    if (notches != 0) {
+        Append(m_eventBuffer, eventCount, EV_REL, axis, notches);
+        remainder -= notches * WHEEL_UNITS_PER_NOTCH;
+    }
+}
+
+size_t UinputSink::send(const InputEvent* events, size_t count) {
+    size_t sent = 0;
+
+    while (sent < count) {
+        size_t batchStart = sent;
+        size_t eventCount = 0;
+
+        for (size_t batched = 0; sent < count && batched < MAX_BATCH; sent++, batched++) {
+            const InputEvent& event = events[sent];
+
+            switch (event.type) {
+                case InputEventType::MOUSE_MOVE:
+                    if (event.dx != 0) Append(m_eventBuffer, eventCount, EV_REL, REL_X, event.dx);
+                    if (event.dy != 0) Append(m_eventBuffer, eventCount, EV_REL, REL_Y, event.dy);
+                    break;
+                case InputEventType::MOUSE_BUTTON:
+                    if (event.code == 0 || (event.code & ~MOUSE_BUTTON_MASK)) continue;
+                    m_eventBuffer[eventCount++] = BUTTON_EVENTS.events[CountTrailingZeros(event.code)][event.value != 0];
+                    break;
+                case InputEventType::MOUSE_WHEEL:
+                    appendWheel(eventCount, REL_WHEEL, WHEEL_HI_RES_AXIS, m_wheelRemainder, event.value);
+                    break;
+                case InputEventType::MOUSE_HWHEEL:
+                    appendWheel(eventCount, REL_HWHEEL, HWHEEL_HI_RES_AXIS, m_hwheelRemainder, event.value);
+                    break;
+                case InputEventType::KEY: {
+                    uint16_t code = HidUsageToEvdev(event.code);
+                    if (code == 0) continue;
+                    Append(m_eventBuffer, eventCount, EV_KEY, code, event.value);
+                    break;
+                }
+                case InputEventType::GAMEPAD_AXIS:
+                case InputEventType::GAMEPAD_BUTTON:
+                    // Injected by UinputGamepadSink
+                    continue;
+            }
+
+            // One frame per event so press/release pairs are not collapsed
+            m_eventBuffer[eventCount++] = SYN_EVENT;
+        }
+
+        if (eventCount > 0 && m_fd >= 0) {
+            uint64_t writeStart = MonotonicNanos();
+            ssize_t written = write(m_fd, m_eventBuffer, eventCount * sizeof(input_event));
+            recordWrite(sent - batchStart, writeStart);
+            if (written < 0)
+                return batchStart;
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <linux/input.h>
+
+#include "../../core/input_backend.h"
+
+// Injects events through a virtual /dev/uinput device that advertises
+// LOOPBACK_VENDOR_ID/LOOPBACK_PRODUCT_ID.
+class UinputSink : public InputSink {
+public:
+    static constexpr size_t MAX_BATCH = MAX_INJECT_BATCH;
+
+    ~UinputSink() override;
+
+    const char* name() const override { return "uinput"; }
+    bool open() override;
+    void close() override;
+    size_t send(const InputEvent* events, size_t count) override;
+
+private:
+    // Emits the full-resolution wheel delta and whole detents for clients
+    // that only read the legacy axis
+    void appendWheel(size_t& eventCount, uint16_t axis, uint16_t hiResAxis,
+                     int32_t& remainder, int32_t value);
+
+    int m_fd = -1;
+
+    // Sub-detent wheel travel not yet reported on REL_WHEEL/REL_HWHEEL
+    int32_t m_wheelRemainder = 0;
+    int32_t m_hwheelRemainder = 0;
+
+    // Each injected event expands to at most two evdev events plus SYN
+    input_event m_eventBuffer[MAX_BATCH * 4];
+};
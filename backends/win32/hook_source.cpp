@@ -0,0 +1,267 @@
+#include "hook_source.h"
+
+#include <iostream>
+
+#include "../../core/clock.h"
+#include "../../core/input_pipeline.h"
+#include "../../core/keycodes.h"
+#include "sendinput_sink.h"
+
+namespace {
+
+// Hook callbacks carry no user data, so the active source lives here
+Win32HookSource* g_source = nullptr;
+
+// Upper bound on a parked wait so stop() stays responsive
+constexpr auto IDLE_WAIT_TIMEOUT = std::chrono::milliseconds(100);
+
+// Our own SendInput output, recognised per event so real input arriving
+// during injection is still captured
+bool IsLoopbackInjected(DWORD flags, DWORD injectedFlag, ULONG_PTR extraInfo) {
+    return (flags & injectedFlag) != 0 && extraInfo == LOOPBACK_INJECTION_TAG;
+}
+
+}  // namespace
+
+Win32HookSource::~Win32HookSource() {
+    stop();
+}
+
+// Hook side: copy, timestamp, hand over. Nothing here may block or print.
+LRESULT CALLBACK Win32HookSource::MouseProc(int nCode, WPARAM wParam, LPARAM lParam) {
+    if (nCode < 0)
+        return CallNextHookEx(NULL, nCode, wParam, lParam);
+
+    RawHookEvent event;
+    event.timestamp = MonotonicNanos();
+    event.message = wParam;
+    event.kind = EventKind::MOUSE_HOOK;
+    event.mouse = *reinterpret_cast<const MSLLHOOKSTRUCT*>(lParam);
+    g_source->enqueue(event);
+
+    g_source->m_pipeline->captureCallbackNs.record(MonotonicNanos() - event.timestamp);
+    return CallNextHookEx(NULL, nCode, wParam, lParam);
+}
+
+LRESULT CALLBACK Win32HookSource::KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam) {
+    if (nCode < 0)
+        return CallNextHookEx(NULL, nCode, wParam, lParam);
+
+    RawHookEvent event;
+    event.timestamp = MonotonicNanos();
+    event.message = wParam;
+    event.kind = EventKind::KEYBOARD_HOOK;
+    event.key = *reinterpret_cast<const KBDLLHOOKSTRUCT*>(lParam);
+    g_source->enqueue(event);
+
+    // Control keys are swallowed here, where the decision has to be made,
+    // and acted on by the worker. They stay live while blocking so F12 can
+    // turn it off.
+    bool keyDown = wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN;
+    bool swallow = keyDown && !IsLoopbackInjected(event.key.flags, LLKHF_INJECTED, event.key.dwExtraInfo) &&
+                   IsControlKey(VkToHidUsage(static_cast<uint8_t>(event.key.vkCode)));
+
+    g_source->m_pipeline->captureCallbackNs.record(MonotonicNanos() - event.timestamp);
+    return swallow ? 1 : CallNextHookEx(NULL, nCode, wParam, lParam);
+}
+
+void Win32HookSource::forwardMouse(const MouseReport& report) {
+    RawHookEvent event;
+    event.timestamp = report.timestamp;
+    event.message = 0;
+    event.kind = EventKind::MOUSE_REPORT;
+    event.report = report;
+    enqueue(event);
+}
+
+void Win32HookSource::enqueue(const RawHookEvent& event) {
+    if (m_ring.push(event))
+        m_wake.notify();
+    else
+        m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Worker side
+void Win32HookSource::run() {
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+
+    RawHookEvent event;
+    while (!m_stop.load(std::memory_order_acquire)) {
+        while (m_ring.pop(event)) {
+            switch (event.kind) {
+                case EventKind::MOUSE_HOOK:
+                    handleMouse(event);
+                    break;
+                case EventKind::KEYBOARD_HOOK:
+                    handleKeyboard(event);
+                    break;
+                case EventKind::MOUSE_REPORT: {
+                    MouseReport report = event.report;
+                    m_pipeline->pushMouse(report);
+                    break;
+                }
+            }
+        }
+
+        m_wake.wait(m_pipeline->waitMode, m_pipeline->spinBudget, IDLE_WAIT_TIMEOUT, [&] {
+            return !m_ring.isEmpty() || m_stop.load(std::memory_order_relaxed);
+        });
+    }
+}
+
+void Win32HookSource::handleMouse(const RawHookEvent& event) {
+    const MSLLHOOKSTRUCT& mouse = event.mouse;
+    if (IsLoopbackInjected(mouse.flags, LLMHF_INJECTED, mouse.dwExtraInfo)) {
+        // Keep the cursor baseline current so the next real move is a true delta
+        if (event.message == WM_MOUSEMOVE)
+            m_lastCursorPos = mouse.pt;
+        return;
+    }
+
+    // Skip processing if in feedback prevention mode
+    if (m_pipeline->blockFeedback.load(std::memory_order_acquire))
+        return;
+
+    MouseReport report;
+    report.timestamp = event.timestamp;
+    uint8_t buttons = m_mouseButtons;
+
+    switch (event.message) {
+        case WM_MOUSEMOVE:
+            // Get relative movement
+            report.x = mouse.pt.x - m_lastCursorPos.x;
+            report.y = mouse.pt.y - m_lastCursorPos.y;
+            m_lastCursorPos = mouse.pt;
+
+            // Skip sending if no actual movement
+            if (report.x == 0 && report.y == 0)
+                return;
+            break;
+
+        case WM_LBUTTONDOWN:
+            buttons |= MOUSE_BUTTON_LEFT;
+            break;
+        case WM_LBUTTONUP:
+            buttons &= ~MOUSE_BUTTON_LEFT;
+            break;
+        case WM_RBUTTONDOWN:
+            buttons |= MOUSE_BUTTON_RIGHT;
+            break;
+        case WM_RBUTTONUP:
+            buttons &= ~MOUSE_BUTTON_RIGHT;
+            break;
+        case WM_MBUTTONDOWN:
+            buttons |= MOUSE_BUTTON_MIDDLE;
+            break;
+        case WM_MBUTTONUP:
+            buttons &= ~MOUSE_BUTTON_MIDDLE;
+            break;
+        case WM_XBUTTONDOWN:
+        case WM_XBUTTONUP: {
+            // HIWORD(mouseData) says which X button changed
+            uint8_t button = GET_XBUTTON_WPARAM(mouse.mouseData) == XBUTTON1
+                                 ? MOUSE_BUTTON_X1 : MOUSE_BUTTON_X2;
+            buttons = event.message == WM_XBUTTONDOWN ? (buttons | button) : (buttons & ~button);
+            break;
+        }
+        case WM_MOUSEWHEEL:
+            // Raw delta, smaller than WHEEL_DELTA on high-resolution wheels
+            report.wheel = GET_WHEEL_DELTA_WPARAM(mouse.mouseData);
+            break;
+        case WM_MOUSEHWHEEL:
+            report.hwheel = GET_WHEEL_DELTA_WPARAM(mouse.mouseData);
+            break;
+        default:
+            return;
+    }
+
+    // A repeated down or up without a state change carries nothing new
+    bool buttonMessage = report.x == 0 && report.y == 0 && report.wheel == 0 && report.hwheel == 0;
+    if (buttonMessage && buttons == m_mouseButtons)
+        return;
+
+    m_mouseButtons = buttons;
+    report.buttons = buttons;
+    m_pipeline->pushMouse(report);
+}
+
+void Win32HookSource::handleKeyboard(const RawHookEvent& event) {
+    const KBDLLHOOKSTRUCT& key = event.key;
+    if (IsLoopbackInjected(key.flags, LLKHF_INJECTED, key.dwExtraInfo))
+        return;
+
+    uint8_t usage = VkToHidUsage(static_cast<uint8_t>(key.vkCode));
+    bool keyDown = (event.message == WM_KEYDOWN || event.message == WM_SYSKEYDOWN);
+
+    // Already swallowed by the hook; act on it here
+    if (keyDown && HandleControlKey(*m_pipeline, usage))
+        return;
+
+    // Skip processing if in feedback prevention mode or the key is unmapped
+    if (usage == HID_USAGE_NONE || m_pipeline->blockFeedback.load(std::memory_order_acquire))
+        return;
+
+    // Skip if state hasn't changed
+    if (m_keyState.test(usage) == keyDown)
+        return;
+
+    m_keyState.assign(usage, keyDown);
+
+    // Create complete keyboard report
+    KeyboardReport report;
+    report.timestamp = event.timestamp;
+    report.setHeldKeys(m_keyState);
+    m_pipeline->pushKeyboard(report);
+}
+
+// Install hooks with error handling
+bool Win32HookSource::start(InputPipeline& pipeline) {
+    m_pipeline = &pipeline;
+    g_source = this;
+
+    // Get initial cursor position
+    GetCursorPos(&m_lastCursorPos);
+
+    // The worker must be draining before the first callback arrives
+    m_stop.store(false, std::memory_order_relaxed);
+    m_thread = std::thread(&Win32HookSource::run, this);
+
+    // Install mouse hook unless Raw Input owns the mouse
+    if (m_captureMouse) {
+        m_mouseHook = SetWindowsHookEx(WH_MOUSE_LL, MouseProc, GetModuleHandle(NULL), 0);
+        if (!m_mouseHook) {
+            std::cerr << "Failed to install mouse hook. Error: " << GetLastError() << std::endl;
+            stop();
+            return false;
+        }
+    }
+
+    // Install keyboard hook
+    m_keyboardHook = SetWindowsHookEx(WH_KEYBOARD_LL, KeyboardProc, GetModuleHandle(NULL), 0);
+    if (!m_keyboardHook) {
+        std::cerr << "Failed to install keyboard hook. Error: " << GetLastError() << std::endl;
+        stop();
+        return false;
+    }
+
+    return true;
+}
+
+// Clean up hooks and stop the worker
+void Win32HookSource::stop() {
+    if (m_mouseHook) {
+        UnhookWindowsHookEx(m_mouseHook);
+        m_mouseHook = NULL;
+    }
+
+    if (m_keyboardHook) {
+        UnhookWindowsHookEx(m_keyboardHook);
+        m_keyboardHook = NULL;
+    }
+
+    if (m_thread.joinable()) {
+        m_stop.store(true, std::memory_order_release);
+        m_wake.notify();
+        m_thread.join();
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <windows.h>
+
+#include <atomic>
+#include <thread>
+
+#include "../../core/hid_reports.h"
+#include "../../core/input_backend.h"
+#include "../../core/spsc_ring.h"
+#include "../../core/wake_signal.h"
+
+// Low-level mouse/keyboard hook capture. start() must be called from the
+// thread that runs the message loop, since hook callbacks are delivered there.
+// With captureMouse off only the keyboard is hooked, for pairing with
+// RawInputSource.
+//
+// Windows unhooks callbacks that run too long, so the hooks only copy the
+// hook struct and a timestamp into a ring (and swallow control keys); a
+// worker thread does the delta math, state tracking and report building.
+// The worker is the pipeline's only producer: other Windows capture paths
+// hand their finished reports to it through forwardMouse().
+class Win32HookSource : public InputSource {
+public:
+    static constexpr size_t RING_SIZE = 256;
+
+    explicit Win32HookSource(bool captureMouse = true) : m_captureMouse(captureMouse) {}
+    ~Win32HookSource() override;
+
+    const char* name() const override { return "win32-hook"; }
+    bool start(InputPipeline& pipeline) override;
+    void stop() override;
+
+    // Queues a report built on another capture thread (Raw Input) for the
+    // worker to push, so capture order holds across sources. Call between
+    // start() and stop().
+    void forwardMouse(const MouseReport& report);
+
+    // Hook events and forwarded reports lost because the worker fell a full
+    // ring behind
+    uint64_t droppedCount() const { return m_droppedCount.load(std::memory_order_relaxed); }
+
+private:
+    enum class EventKind : uint8_t { MOUSE_HOOK, KEYBOARD_HOOK, MOUSE_REPORT };
+
+    // What a capture thread hands to the worker, as delivered
+    struct RawHookEvent {
+        // MouseReport has a constructor, so the union needs one picked
+        RawHookEvent() : mouse{} {}
+
+        uint64_t timestamp;   // MonotonicNanos() on hook entry
+        WPARAM message;       // WM_MOUSEMOVE, WM_KEYDOWN, ...
+        EventKind kind;
+        union {
+            MSLLHOOKSTRUCT mouse;
+            KBDLLHOOKSTRUCT key;
+            MouseReport report;  // MOUSE_REPORT, ready to push
+        };
+    };
+
+    static LRESULT CALLBACK MouseProc(int nCode, WPARAM wParam, LPARAM lParam);
+    static LRESULT CALLBACK KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam);
+    void enqueue(const RawHookEvent& event);
+
+    void run();
+    void handleMouse(const RawHookEvent& event);
+    void handleKeyboard(const RawHookEvent& event);
+
+    bool m_captureMouse;
+    HHOOK m_mouseHook = NULL;
+    HHOOK m_keyboardHook = NULL;
+    InputPipeline* m_pipeline = nullptr;
+
+    // Hook thread -> worker
+    SpscRing<RawHookEvent, RING_SIZE> m_ring;
+    WakeSignal m_wake;
+    std::atomic<uint64_t> m_droppedCount{0};
+
+    std::thread m_thread;
+    std::atomic<bool> m_stop{false};
+
+    // Only touched by the worker
+    POINT m_lastCursorPos = {0, 0};
+    uint8_t m_mouseButtons = 0;  // Every report carries the full state
+    KeyBitmap m_keyState;        // Held keys as a usage bitset, modifiers included
+};
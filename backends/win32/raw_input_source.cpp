@@ -0,0 +1,179 @@
+#include "raw_input_source.h"
+
+#include <iostream>
+#include <vector>
+
+#include "../../core/clock.h"
+#include "../../core/input_pipeline.h"
+#include "sendinput_sink.h"
+
+namespace {
+
+constexpr const char* WINDOW_CLASS_NAME = "HIDLoopbackRawInput";
+
+// Generic desktop page, mouse usage
+constexpr USHORT HID_USAGE_PAGE_GENERIC = 0x01;
+constexpr USHORT HID_USAGE_GENERIC_MOUSE = 0x02;
+
+struct RawButton {
+    USHORT downFlag;
+    USHORT upFlag;
+    uint8_t button;
+};
+
+constexpr RawButton RAW_BUTTONS[] = {
+    {RI_MOUSE_LEFT_BUTTON_DOWN, RI_MOUSE_LEFT_BUTTON_UP, MOUSE_BUTTON_LEFT},
+    {RI_MOUSE_RIGHT_BUTTON_DOWN, RI_MOUSE_RIGHT_BUTTON_UP, MOUSE_BUTTON_RIGHT},
+    {RI_MOUSE_MIDDLE_BUTTON_DOWN, RI_MOUSE_MIDDLE_BUTTON_UP, MOUSE_BUTTON_MIDDLE},
+    {RI_MOUSE_BUTTON_4_DOWN, RI_MOUSE_BUTTON_4_UP, MOUSE_BUTTON_X1},
+    {RI_MOUSE_BUTTON_5_DOWN, RI_MOUSE_BUTTON_5_UP, MOUSE_BUTTON_X2},
+};
+
+// Window procedures carry no user data, so the active pipeline and the
+// worker that pushes for us live here
+InputPipeline* g_pipeline = nullptr;
+Win32HookSource* g_worker = nullptr;
+
+// Held buttons; every report carries the full state
+uint8_t g_mouseButtons = 0;
+
+// Raw Input device handles by report device ID - 1, in order of first input
+std::vector<HANDLE> g_devices;
+
+uint16_t DeviceId(HANDLE device) {
+    for (size_t i = 0; i < g_devices.size(); i++) {
+        if (g_devices[i] == device)
+            return static_cast<uint16_t>(i + 1);
+    }
+    g_devices.push_back(device);
+    return static_cast<uint16_t>(g_devices.size());
+}
+
+// Last position from absolute devices (tablets, remote desktop), in pixels
+bool g_haveAbsolute = false;
+LONG g_lastAbsoluteX = 0;
+LONG g_lastAbsoluteY = 0;
+
+// Absolute devices report 0-65535 across the primary or virtual desktop;
+// turn that into a pixel delta against the previous sample
+void AbsoluteToDelta(const RAWMOUSE& mouse, LONG& dx, LONG& dy) {
+    bool virtualDesktop = (mouse.usFlags & MOUSE_VIRTUAL_DESKTOP) != 0;
+    LONG width = GetSystemMetrics(virtualDesktop ? SM_CXVIRTUALSCREEN : SM_CXSCREEN);
+    LONG height = GetSystemMetrics(virtualDesktop ? SM_CYVIRTUALSCREEN : SM_CYSCREEN);
+    LONG x = static_cast<LONG>(static_cast<long long>(mouse.lLastX) * width / 65535);
+    LONG y = static_cast<LONG>(static_cast<long long>(mouse.lLastY) * height / 65535);
+
+    dx = g_haveAbsolute ? x - g_lastAbsoluteX : 0;
+    dy = g_haveAbsolute ? y - g_lastAbsoluteY : 0;
+    g_lastAbsoluteX = x;
+    g_lastAbsoluteY = y;
+    g_haveAbsolute = true;
+}
+
+void HandleRawInput(HRAWINPUT handle) {
+    RAWINPUT raw;
+    UINT size = sizeof(raw);
+    if (GetRawInputData(handle, RID_INPUT, &raw, &size, sizeof(RAWINPUTHEADER)) == static_cast<UINT>(-1) ||
+        raw.header.dwType != RIM_TYPEMOUSE) {
+        return;
+    }
+
+    // SendInput events arrive without a device handle, and ours carry the
+    // injection tag; never capture either
+    const RAWMOUSE& mouse = raw.data.mouse;
+    if (raw.header.hDevice == NULL || mouse.ulExtraInformation == LOOPBACK_INJECTION_TAG ||
+        g_pipeline->blockFeedback.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    MouseReport report;
+    report.timestamp = MonotonicNanos();
+    report.device = DeviceId(raw.header.hDevice);
+
+    LONG dx = mouse.lLastX;
+    LONG dy = mouse.lLastY;
+    if (mouse.usFlags & MOUSE_MOVE_ABSOLUTE)
+        AbsoluteToDelta(mouse, dx, dy);
+    report.x = dx;
+    report.y = dy;
+
+    uint8_t buttons = g_mouseButtons;
+    for (const RawButton& entry : RAW_BUTTONS) {
+        if (mouse.usButtonFlags & entry.downFlag) buttons |= entry.button;
+        if (mouse.usButtonFlags & entry.upFlag) buttons &= ~entry.button;
+    }
+
+    // Wheel deltas are signed and already in WHEEL_DELTA units
+    if (mouse.usButtonFlags & RI_MOUSE_WHEEL)
+        report.wheel = static_cast<SHORT>(mouse.usButtonData);
+    if (mouse.usButtonFlags & RI_MOUSE_HWHEEL)
+        report.hwheel = static_cast<SHORT>(mouse.usButtonData);
+
+    if (report.x == 0 && report.y == 0 && report.wheel == 0 && report.hwheel == 0 &&
+        buttons == g_mouseButtons) {
+        return;
+    }
+
+    g_mouseButtons = buttons;
+    report.buttons = buttons;
+    g_worker->forwardMouse(report);
+}
+
+LRESULT CALLBACK RawInputWindowProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam) {
+    if (message == WM_INPUT)
+        HandleRawInput(reinterpret_cast<HRAWINPUT>(lParam));
+    return DefWindowProc(hwnd, message, wParam, lParam);
+}
+
+}  // namespace
+
+bool RawInputSource::start(InputPipeline& pipeline) {
+    g_pipeline = &pipeline;
+    g_worker = &m_worker;
+
+    WNDCLASSEXA windowClass;
+    ZeroMemory(&windowClass, sizeof(windowClass));
+    windowClass.cbSize = sizeof(windowClass);
+    windowClass.lpfnWndProc = RawInputWindowProc;
+    windowClass.hInstance = GetModuleHandle(NULL);
+    windowClass.lpszClassName = WINDOW_CLASS_NAME;
+    RegisterClassExA(&windowClass);
+
+    m_window = CreateWindowExA(0, WINDOW_CLASS_NAME, "", 0, 0, 0, 0, 0,
+                               HWND_MESSAGE, NULL, GetModuleHandle(NULL), NULL);
+    if (!m_window) {
+        std::cerr << "Failed to create raw input window. Error: " << GetLastError() << std::endl;
+        return false;
+    }
+
+    // Receive mouse input even while another window has focus
+    RAWINPUTDEVICE device;
+    device.usUsagePage = HID_USAGE_PAGE_GENERIC;
+    device.usUsage = HID_USAGE_GENERIC_MOUSE;
+    device.dwFlags = RIDEV_INPUTSINK;
+    device.hwndTarget = m_window;
+    if (!RegisterRawInputDevices(&device, 1, sizeof(device))) {
+        std::cerr << "Failed to register raw mouse input. Error: " << GetLastError() << std::endl;
+        DestroyWindow(m_window);
+        m_window = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+void RawInputSource::stop() {
+    if (!m_window)
+        return;
+
+    RAWINPUTDEVICE device;
+    device.usUsagePage = HID_USAGE_PAGE_GENERIC;
+    device.usUsage = HID_USAGE_GENERIC_MOUSE;
+    device.dwFlags = RIDEV_REMOVE;
+    device.hwndTarget = NULL;
+    RegisterRawInputDevices(&device, 1, sizeof(device));
+
+    DestroyWindow(m_window);
+    m_window = NULL;
+    UnregisterClassA(WINDOW_CLASS_NAME, GetModuleHandle(NULL));
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <windows.h>
+
+#include "../../core/input_backend.h"
+#include "hook_source.h"
+
+// Relative mouse capture through Raw Input. Deltas are device counts taken
+// before pointer acceleration, screen-edge clamping and multi-monitor
+// mapping. WM_INPUT goes to a message-only window, so like the hooks,
+// start() must be called from the thread that runs the message loop.
+// Reports are pushed by the hook source's worker, which must already be
+// running, so the pipeline keeps a single producer.
+class RawInputSource : public InputSource {
+public:
+    explicit RawInputSource(Win32HookSource& worker) : m_worker(worker) {}
+
+    const char* name() const override { return "win32-rawinput"; }
+    bool start(InputPipeline& pipeline) override;
+    void stop() override;
+
+private:
+    Win32HookSource& m_worker;
+    HWND m_window = NULL;
+};
@@ -0,0 +1,147 @@
+#include "sendinput_sink.h"
+
+#include "../../core/hid_reports.h"
+#include "../../core/keycodes.h"
+
+namespace {
+
+// Keys that live in the extended (E0-prefixed) scan code block
+bool IsExtendedVk(WORD vk) {
+    switch (vk) {
+        case VK_INSERT: case VK_DELETE: case VK_HOME: case VK_END:
+        case VK_PRIOR: case VK_NEXT: case VK_LEFT: case VK_RIGHT:
+        case VK_UP: case VK_DOWN: case VK_DIVIDE: case VK_NUMLOCK:
+        case VK_RCONTROL: case VK_RMENU: case VK_LWIN: case VK_RWIN:
+        case VK_APPS: case VK_SNAPSHOT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Button bit -> SendInput flags; the INPUT templates below are generated
+// from this table
+struct ButtonDescriptor {
+    uint8_t button;
+    DWORD downFlag;
+    DWORD upFlag;
+    DWORD mouseData;
+};
+
+constexpr ButtonDescriptor BUTTON_DESCRIPTORS[] = {
+    {MOUSE_BUTTON_LEFT, MOUSEEVENTF_LEFTDOWN, MOUSEEVENTF_LEFTUP, 0},
+    {MOUSE_BUTTON_RIGHT, MOUSEEVENTF_RIGHTDOWN, MOUSEEVENTF_RIGHTUP, 0},
+    {MOUSE_BUTTON_MIDDLE, MOUSEEVENTF_MIDDLEDOWN, MOUSEEVENTF_MIDDLEUP, 0},
+    {MOUSE_BUTTON_X1, MOUSEEVENTF_XDOWN, MOUSEEVENTF_XUP, XBUTTON1},
+    {MOUSE_BUTTON_X2, MOUSEEVENTF_XDOWN, MOUSEEVENTF_XUP, XBUTTON2},
+};
+
+static_assert(sizeof(BUTTON_DESCRIPTORS) / sizeof(BUTTON_DESCRIPTORS[0]) == MOUSE_BUTTON_COUNT);
+
+constexpr INPUT MakeMouseInput(DWORD flags, DWORD mouseData) {
+    INPUT input{};
+    input.type = INPUT_MOUSE;
+    input.mi.dwFlags = flags;
+    input.mi.mouseData = mouseData;
+    input.mi.dwExtraInfo = LOOPBACK_INJECTION_TAG;
+    return input;
+}
+
+constexpr INPUT MOVE_INPUT = MakeMouseInput(MOUSEEVENTF_MOVE, 0);
+constexpr INPUT WHEEL_INPUT = MakeMouseInput(MOUSEEVENTF_WHEEL, 0);
+constexpr INPUT HWHEEL_INPUT = MakeMouseInput(MOUSEEVENTF_HWHEEL, 0);
+
+// Complete INPUT per button bit and direction, copied into the batch as is
+struct ButtonInputTable {
+    INPUT inputs[MOUSE_BUTTON_COUNT][2];
+};
+
+constexpr ButtonInputTable MakeButtonInputTable() {
+    ButtonInputTable table{};
+    for (const ButtonDescriptor& descriptor : BUTTON_DESCRIPTORS) {
+        unsigned bit = 0;
+        while (!((descriptor.button >> bit) & 1))
+            bit++;
+        table.inputs[bit][0] = MakeMouseInput(descriptor.upFlag, descriptor.mouseData);
+        table.inputs[bit][1] = MakeMouseInput(descriptor.downFlag, descriptor.mouseData);
+    }
+    return table;
+}
+
+constexpr ButtonInputTable BUTTON_INPUTS = MakeButtonInputTable();
+
+// Returns one past the event marked as ending the report that starts at start
+size_t ReportEnd(const InputEvent* events, size_t start, size_t count) {
+    size_t end = start + 1;
+    while (end < count && !events[end - 1].endOfReport)
+        end++;
+    return end;
+}
+
+}  // namespace
+
+size_t SendInputSink::send(const InputEvent* events, size_t count) {
+    size_t sent = 0;
+
+    while (sent < count) {
+        UINT inputCount = 0;
+        size_t batchStart = sent;
+        size_t reportEnd = sent;
+
+        for (; sent < count && inputCount < MAX_BATCH; sent++) {
+            // A report that does not fit goes out whole in the next call
+            if (sent == reportEnd) {
+                reportEnd = ReportEnd(events, sent, count);
+                if (inputCount > 0 && inputCount + (reportEnd - sent) > MAX_BATCH)
+                    break;
+            }
+
+            const InputEvent& event = events[sent];
+            INPUT& input = m_inputBuffer[inputCount];
+
+            switch (event.type) {
+                case InputEventType::MOUSE_MOVE:
+                    input = MOVE_INPUT;
+                    input.mi.dx = event.dx;
+                    input.mi.dy = event.dy;
+                    break;
+                case InputEventType::MOUSE_BUTTON:
+                    if (event.code == 0 || (event.code & ~MOUSE_BUTTON_MASK)) continue;
+                    input = BUTTON_INPUTS.inputs[CountTrailingZeros(event.code)][event.value != 0];
+                    break;
+                case InputEventType::MOUSE_WHEEL:
+                    input = WHEEL_INPUT;
+                    input.mi.mouseData = static_cast<DWORD>(event.value);
+                    break;
+                case InputEventType::MOUSE_HWHEEL:
+                    input = HWHEEL_INPUT;
+                    input.mi.mouseData = static_cast<DWORD>(event.value);
+                    break;
+                case InputEventType::KEY: {
+                    WORD vk = HidUsageToVk(event.code);
+                    if (vk == 0) continue;
+                    ZeroMemory(&input, sizeof(INPUT));
+                    input.type = INPUT_KEYBOARD;
+                    input.ki.wVk = vk;
+                    input.ki.dwFlags = (event.value ? 0 : KEYEVENTF_KEYUP) |
+                                       (IsExtendedVk(vk) ? KEYEVENTF_EXTENDEDKEY : 0);
+                    input.ki.dwExtraInfo = LOOPBACK_INJECTION_TAG;
+                    break;
+                }
+                case InputEventType::GAMEPAD_AXIS:
+                case InputEventType::GAMEPAD_BUTTON:
+                    // SendInput has no gamepad input type
+                    continue;
+            }
+            inputCount++;
+        }
+
+        if (inputCount > 0) {
+            uint64_t writeStart = MonotonicNanos();
+            SendInput(inputCount, m_inputBuffer, sizeof(INPUT));
+            recordWrite(sent - batchStart, writeStart);
+        }
+    }
+
+    return count;
+}
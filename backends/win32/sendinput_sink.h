@@ -0,0 +1,25 @@
+#pragma once
+
+#include <windows.h>
+
+#include "../../core/input_backend.h"
+
+// dwExtraInfo stamped on every injected INPUT. The capture sources drop
+// events carrying it (with the injected flag set) and keep everything else,
+// including input other programs inject. 32 bits so it survives
+// RAWMOUSE::ulExtraInformation.
+constexpr ULONG_PTR LOOPBACK_INJECTION_TAG = 0x4C4F4F50;  // "LOOP"
+
+// Injects events through SendInput
+class SendInputSink : public InputSink {
+public:
+    static constexpr size_t MAX_BATCH = MAX_INJECT_BATCH;
+
+    const char* name() const override { return "sendinput"; }
+    bool open() override { return true; }
+    void close() override {}
+    size_t send(const InputEvent* events, size_t count) override;
+
+private:
+    INPUT m_inputBuffer[MAX_BATCH];
+};
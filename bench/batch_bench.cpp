@@ -0,0 +1,110 @@
+// Injection batching under bursty mouse input: the original fixed flush at
+// 10 events against the adaptive BatchSizer. Runs the real processing loop
+// into a sink that costs a fixed amount per write plus a little per event,
+// and reports writes, events per write and dequeue->inject latency.
+//
+// Build: g++ -std=c++20 -O2 -pthread bench/batch_bench.cpp core/async_logger.cpp core/input_pipeline.cpp core/keycodes.cpp core/latency_histogram.cpp core/trace_recorder.cpp core/wake_signal.cpp -o batch_bench
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+
+#include "../core/input_pipeline.h"
+#include "bench_util.h"
+
+namespace {
+
+constexpr uint64_t WRITE_COST_NS = 4000;      // Roughly one SendInput/write call
+constexpr uint64_t EVENT_COST_NS = 100;
+
+// Stands in for a syscall-backed sink by spinning for the modelled cost
+class CostSink : public InputSink {
+public:
+    const char* name() const override { return "cost"; }
+    bool open() override { return true; }
+    void close() override {}
+
+    size_t send(const InputEvent* events, size_t count) override {
+        (void)events;
+        for (size_t sent = 0; sent < count;) {
+            size_t batch = std::min(count - sent, MAX_INJECT_BATCH);
+            uint64_t writeStart = MonotonicNanos();
+            while (MonotonicNanos() - writeStart < WRITE_COST_NS + EVENT_COST_NS * batch)
+                CpuRelax();
+            recordWrite(batch, writeStart);
+            sent += batch;
+            writeCount++;
+        }
+        eventCount += count;
+        return count;
+    }
+
+    uint64_t writeCount = 0;
+    uint64_t eventCount = 0;
+};
+
+void Run(const char* name, const BatchPolicy& policy, int bursts, size_t burstSize) {
+    auto pipeline = std::make_unique<InputPipeline>();
+    pipeline->batchPolicy = policy;
+    // Polling lets each burst queue up whole before the drain, even on one core
+    pipeline->waitMode = WaitMode::POLL;
+    CostSink sink;
+
+    std::thread processThread(ProcessInputEvents, std::ref(*pipeline), std::ref(sink));
+
+    uint64_t start = BenchNowNs();
+    for (int burst = 0; burst < bursts; burst++) {
+        // Alternate buttons so reports are never coalesced in the queue
+        for (size_t i = 0; i < burstSize; i++) {
+            MouseReport report;
+            report.x = 1;
+            report.buttons = (i & 1) ? MOUSE_BUTTON_LEFT : 0;
+            report.timestamp = MonotonicNanos();
+            pipeline->pushMouse(report);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(POLLING_INTERVAL_MS * 2));
+    }
+    uint64_t elapsed = BenchNowNs() - start;
+
+    pipeline->running = false;
+    pipeline->wakeSignal.notify();
+    processThread.join();
+
+    auto inject = std::make_unique<LatencyHistogram::Snapshot>();
+    pipeline->latency.at(LatencyDevice::MOUSE, LatencyStage::DEQUEUE_TO_INJECT).snapshot(*inject);
+
+    std::printf("%-36s %8llu writes %7.1f events/write %8.1f us sink time/burst\n", name,
+                static_cast<unsigned long long>(sink.writeCount),
+                sink.writeCount ? static_cast<double>(sink.eventCount) / sink.writeCount : 0.0,
+                static_cast<double>(sink.writeCount * WRITE_COST_NS + sink.eventCount * EVENT_COST_NS) / 1000.0 /
+                    bursts);
+    std::printf("%-36s dequeue->inject p50 %7.1f us, p99 %7.1f us, max %7.1f us (%.0f ms run)\n", "",
+                inject->percentile(50.0) / 1000.0, inject->percentile(99.0) / 1000.0,
+                inject->max / 1000.0, elapsed / 1e6);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int bursts = argc > 1 ? std::atoi(argv[1]) : 500;
+
+    BatchPolicy fixed;
+    fixed.minEvents = 10;
+    fixed.maxEvents = 10;
+    fixed.latencyBudget = std::chrono::seconds(1);
+
+    BatchPolicy adaptive;
+
+    std::printf("Injection batching, %d bursts, %llu us + %llu ns/event per write\n", bursts,
+                static_cast<unsigned long long>(WRITE_COST_NS / 1000),
+                static_cast<unsigned long long>(EVENT_COST_NS));
+
+    for (size_t burstSize : {size_t(4), size_t(32)}) {
+        std::printf("\n%zu reports per burst\n", burstSize);
+        Run("fixed flush at 10 events", fixed, bursts, burstSize);
+        Run("adaptive batch", adaptive, bursts, burstSize);
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+// Shared helpers for the standalone microbenchmarks in bench/
+
+#include <stdint.h>
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+inline uint64_t BenchNowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Keeps the optimizer from discarding a computed value
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+// Pin the calling thread to a CPU so cross-core numbers are repeatable
+inline void PinToCpu(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % static_cast<int>(std::thread::hardware_concurrency()), &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+// Hardware cache-miss counter for the whole process, including threads
+// spawned after start(). Reports unavailable when perf events are not
+// permitted (containers, non-Linux hosts).
+class CacheMissCounter {
+public:
+    CacheMissCounter() {
+#ifdef __linux__
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        m_fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~CacheMissCounter() {
+#ifdef __linux__
+        if (m_fd >= 0) close(m_fd);
+#endif
+    }
+
+    bool available() const { return m_fd >= 0; }
+
+    void start() {
+#ifdef __linux__
+        if (m_fd < 0) return;
+        ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    uint64_t stop() {
+        uint64_t count = 0;
+#ifdef __linux__
+        if (m_fd < 0) return 0;
+        ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(m_fd, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+        return count;
+    }
+
+private:
+    int m_fd = -1;
+};
+
+inline void PrintBenchRow(const char* name, uint64_t ops, uint64_t elapsedNs,
+                          const CacheMissCounter& counter, uint64_t misses) {
+    double nsPerOp = ops ? static_cast<double>(elapsedNs) / ops : 0.0;
+    if (counter.available()) {
+        std::printf("%-36s %10.2f ns/op %12.4f misses/op\n", name, nsPerOp,
+                    ops ? static_cast<double>(misses) / ops : 0.0);
+    } else {
+        std::printf("%-36s %10.2f ns/op %12s misses/op\n", name, nsPerOp, "n/a");
+    }
+}
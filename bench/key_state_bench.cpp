@@ -0,0 +1,133 @@
+// Keyboard hook body cost: the original bool[256] state with a full scan per
+// callback against the usage bitset with ctz extraction.
+//
+// Build: g++ -std=c++20 -O2 bench/key_state_bench.cpp core/keycodes.cpp -o key_state_bench
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../core/hid_reports.h"
+#include "bench_util.h"
+
+namespace {
+
+constexpr size_t SEQUENCE_LENGTH = 4096;
+
+struct KeyTransition {
+    uint8_t usage;
+    bool down;
+};
+
+// Presses and releases that keep roughly `held` keys down, with modifiers
+// toggling now and then
+std::vector<KeyTransition> MakeTransitions(size_t held) {
+    std::mt19937 rng(42);
+    std::vector<KeyTransition> transitions;
+    std::vector<uint8_t> down;
+
+    transitions.reserve(SEQUENCE_LENGTH);
+    while (transitions.size() < SEQUENCE_LENGTH) {
+        if (rng() % 8 == 0) {
+            uint8_t usage = static_cast<uint8_t>(HID_USAGE_LCTRL + rng() % 8);
+            transitions.push_back({usage, rng() % 2 == 0});
+        } else if (down.size() > held || (down.size() == held && held != 0)) {
+            size_t index = rng() % down.size();
+            transitions.push_back({down[index], false});
+            down.erase(down.begin() + index);
+        } else {
+            uint8_t usage = static_cast<uint8_t>(0x04 + rng() % 0x60);
+            bool duplicate = false;
+            for (uint8_t d : down) duplicate |= d == usage;
+            if (duplicate) continue;
+            down.push_back(usage);
+            transitions.push_back({usage, true});
+        }
+    }
+    return transitions;
+}
+
+// Original hook body: bool state and a scan of every usage
+struct LegacyKeyState {
+    bool keyState[256] = {false};
+
+    bool update(const KeyTransition& transition, BootKeyboardReport& report) {
+        if (keyState[transition.usage] == transition.down)
+            return false;
+        keyState[transition.usage] = transition.down;
+
+        int keyIndex = 0;
+        for (int i = 0; i < 256; i++) {
+            if (!keyState[i]) continue;
+
+            if (IsModifierUsage(static_cast<uint8_t>(i))) {
+                report.modifiers |= ModifierBitForUsage(static_cast<uint8_t>(i));
+            } else if (keyIndex < 6) {
+                report.keys[keyIndex++] = static_cast<uint8_t>(i);
+            }
+        }
+        return true;
+    }
+};
+
+struct BitmapKeyState {
+    KeyBitmap keyState;
+
+    bool update(const KeyTransition& transition, BootKeyboardReport& report) {
+        if (keyState.test(transition.usage) == transition.down)
+            return false;
+        keyState.assign(transition.usage, transition.down);
+        report.setHeldKeys(keyState);
+        return true;
+    }
+};
+
+template <typename State>
+void BenchKeyState(const char* name, const std::vector<KeyTransition>& transitions,
+                   uint64_t passes, uint64_t& checksum) {
+    State state;
+    CacheMissCounter counter;
+    uint64_t reports = 0;
+    uint64_t sum = 0;
+
+    counter.start();
+    uint64_t start = BenchNowNs();
+    for (uint64_t p = 0; p < passes; p++) {
+        for (const KeyTransition& transition : transitions) {
+            BootKeyboardReport report;
+            if (!state.update(transition, report))
+                continue;
+            DoNotOptimize(report);
+            sum += report.modifiers + report.keys[0] + report.keys[5];
+            reports++;
+        }
+    }
+    uint64_t elapsed = BenchNowNs() - start;
+    uint64_t misses = counter.stop();
+
+    PrintBenchRow(name, passes * transitions.size(), elapsed, counter, misses);
+    checksum = sum;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint64_t passes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000;
+
+    std::printf("Key state benchmark, %llu passes over %zu transitions (cost per hook callback)\n",
+                static_cast<unsigned long long>(passes), SEQUENCE_LENGTH);
+
+    for (size_t held : {0, 2, 6, 10}) {
+        std::vector<KeyTransition> transitions = MakeTransitions(held);
+        uint64_t legacySum = 0;
+        uint64_t bitmapSum = 0;
+
+        std::printf("\n~%zu keys held\n", held);
+        BenchKeyState<LegacyKeyState>("bool[256] scan", transitions, passes, legacySum);
+        BenchKeyState<BitmapKeyState>("bitset + ctz", transitions, passes, bitmapSum);
+        if (legacySum != bitmapSum)
+            std::printf("report mismatch between implementations\n");
+    }
+    return 0;
+}
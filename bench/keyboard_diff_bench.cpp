@@ -0,0 +1,150 @@
+// Keyboard translation under heavy chording: the original per-report key-down
+// emission against the diff engine that emits only real transitions.
+//
+// Build: g++ -std=c++20 -O2 -pthread bench/keyboard_diff_bench.cpp core/async_logger.cpp core/input_pipeline.cpp core/keycodes.cpp core/latency_histogram.cpp core/trace_recorder.cpp core/wake_signal.cpp -o keyboard_diff_bench
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../core/input_pipeline.h"
+#include "bench_util.h"
+
+namespace {
+
+constexpr size_t SEQUENCE_LENGTH = 4096;
+
+// Original translation: a key-down for every held key in every report
+size_t LegacyTranslateKeyboardReport(const BootKeyboardReport& report, InputEvent* out) {
+    size_t count = 0;
+    for (int i = 0; i < 6; i++) {
+        if (report.keys[i] == 0) continue;
+
+        InputEvent& event = out[count++];
+        event = InputEvent{};
+        event.type = InputEventType::KEY;
+        event.code = report.keys[i];
+        event.value = 1;
+    }
+    return count;
+}
+
+// Rolling chords: each report presses or releases one key or modifier,
+// keeping up to six letter/digit keys held at once
+std::vector<BootKeyboardReport> MakeChordSequence() {
+    std::mt19937 rng(42);
+    std::vector<BootKeyboardReport> reports;
+    std::vector<uint8_t> held;
+    uint8_t modifiers = 0;
+
+    reports.reserve(SEQUENCE_LENGTH);
+    while (reports.size() < SEQUENCE_LENGTH) {
+        uint32_t roll = rng() % 8;
+        if (roll == 0) {
+            modifiers ^= static_cast<uint8_t>(1u << (rng() % 8));
+        } else if (held.size() == 6 || (!held.empty() && roll < 4)) {
+            held.erase(held.begin() + rng() % held.size());
+        } else {
+            uint8_t usage = static_cast<uint8_t>(0x04 + rng() % 36);
+            bool duplicate = false;
+            for (uint8_t h : held) duplicate |= h == usage;
+            if (duplicate) continue;
+            held.push_back(usage);
+        }
+
+        BootKeyboardReport report;
+        report.modifiers = modifiers;
+        for (size_t i = 0; i < held.size(); i++) report.keys[i] = held[i];
+        reports.push_back(report);
+    }
+    return reports;
+}
+
+// Replays emitted events onto a key set and counts reports whose resulting
+// state differs from the report itself
+struct StateCheck {
+    KeyBitmap state;
+    uint64_t mismatches = 0;
+
+    void apply(const InputEvent* events, size_t count, const BootKeyboardReport& report) {
+        for (size_t i = 0; i < count; i++) {
+            if (events[i].value) state.set(events[i].code);
+            else state.clear(events[i].code);
+        }
+        KeyBitmap expected;
+        expected.setModifiers(report.modifiers);
+        for (uint8_t key : report.keys)
+            if (key) expected.set(key);
+        if (!(state == expected)) mismatches++;
+    }
+};
+
+void BenchLegacy(const std::vector<BootKeyboardReport>& reports, uint64_t passes) {
+    InputEvent events[BootKeyboardReport::MAX_TRANSITIONS];
+    CacheMissCounter counter;
+    StateCheck check;
+    uint64_t eventCount = 0;
+
+    counter.start();
+    uint64_t start = BenchNowNs();
+    for (uint64_t p = 0; p < passes; p++) {
+        for (const BootKeyboardReport& report : reports) {
+            size_t count = LegacyTranslateKeyboardReport(report, events);
+            DoNotOptimize(events[0]);
+            eventCount += count;
+        }
+    }
+    uint64_t elapsed = BenchNowNs() - start;
+    uint64_t misses = counter.stop();
+
+    for (const BootKeyboardReport& report : reports)
+        check.apply(events, LegacyTranslateKeyboardReport(report, events), report);
+
+    PrintBenchRow("per-report key-downs (legacy)", passes * reports.size(), elapsed, counter, misses);
+    std::printf("%-36s %10.2f events/report %8llu wrong states\n", "",
+                static_cast<double>(eventCount) / (passes * reports.size()),
+                static_cast<unsigned long long>(check.mismatches));
+}
+
+void BenchDiff(const std::vector<BootKeyboardReport>& reports, uint64_t passes) {
+    InputEvent events[BootKeyboardReport::MAX_TRANSITIONS];
+    BootKeyboardReport lastState;
+    CacheMissCounter counter;
+    StateCheck check;
+    uint64_t eventCount = 0;
+
+    counter.start();
+    uint64_t start = BenchNowNs();
+    for (uint64_t p = 0; p < passes; p++) {
+        for (const BootKeyboardReport& report : reports) {
+            size_t count = TranslateKeyboardReport(report, lastState, 0, events);
+            DoNotOptimize(events[0]);
+            eventCount += count;
+        }
+    }
+    uint64_t elapsed = BenchNowNs() - start;
+    uint64_t misses = counter.stop();
+
+    lastState = BootKeyboardReport();
+    for (const BootKeyboardReport& report : reports)
+        check.apply(events, TranslateKeyboardReport(report, lastState, 0, events), report);
+
+    PrintBenchRow("diff engine", passes * reports.size(), elapsed, counter, misses);
+    std::printf("%-36s %10.2f events/report %8llu wrong states\n", "",
+                static_cast<double>(eventCount) / (passes * reports.size()),
+                static_cast<unsigned long long>(check.mismatches));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint64_t passes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000;
+    std::vector<BootKeyboardReport> reports = MakeChordSequence();
+
+    std::printf("Keyboard diff benchmark, %llu passes over %zu chording reports (cost per report)\n\n",
+                static_cast<unsigned long long>(passes), reports.size());
+    BenchLegacy(reports, passes);
+    BenchDiff(reports, passes);
+    return 0;
+}
@@ -0,0 +1,88 @@
+// Cost of a status message on the thread that emits it: the original
+// `std::cout << ... << std::endl` against posting a record to AsyncLogger.
+// Both write into a stream whose flush stalls like a busy console, and each
+// message's time on the calling thread goes into a latency histogram.
+//
+// Build: g++ -std=c++20 -O2 -pthread bench/log_bench.cpp core/async_logger.cpp core/latency_histogram.cpp core/wake_signal.cpp -o log_bench
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <thread>
+
+#include "../core/async_logger.h"
+#include "../core/clock.h"
+#include "bench_util.h"
+
+namespace {
+
+constexpr uint64_t FLUSH_COST_NS = 20000;   // A console write that has to wait
+constexpr size_t MESSAGES_PER_BURST = 8;
+
+// Discards the text but charges every flush the modelled console cost
+class SlowConsoleBuf : public std::stringbuf {
+protected:
+    int sync() override {
+        uint64_t start = MonotonicNanos();
+        while (MonotonicNanos() - start < FLUSH_COST_NS)
+            CpuRelax();
+        str(std::string());
+        return 0;
+    }
+};
+
+void PrintRow(const char* name, const LatencyHistogram& histogram, uint64_t dropped) {
+    auto snapshot = std::make_unique<LatencyHistogram::Snapshot>();
+    histogram.snapshot(*snapshot);
+    std::printf("%-28s p50 %8.2f us, p99 %8.2f us, max %8.2f us, %llu dropped\n", name,
+                snapshot->percentile(50.0) / 1000.0, snapshot->percentile(99.0) / 1000.0,
+                snapshot->max / 1000.0, static_cast<unsigned long long>(dropped));
+}
+
+// Bursts of toggles with a pause between them, like a user on F11/F12
+template <typename Emit>
+void RunBursts(int bursts, LatencyHistogram& histogram, Emit&& emit) {
+    for (int burst = 0; burst < bursts; burst++) {
+        for (size_t i = 0; i < MESSAGES_PER_BURST; i++) {
+            uint64_t start = MonotonicNanos();
+            emit(i & 1);
+            histogram.record(MonotonicNanos() - start);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int bursts = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+    std::printf("Status messages, %d bursts of %zu, %llu us per console flush\n", bursts,
+                MESSAGES_PER_BURST, static_cast<unsigned long long>(FLUSH_COST_NS / 1000));
+
+    {
+        SlowConsoleBuf buffer;
+        std::ostream console(&buffer);
+        auto histogram = std::make_unique<LatencyHistogram>();
+        RunBursts(bursts, *histogram, [&](bool on) {
+            console << "Profiling: " << (on ? "ON" : "OFF") << std::endl;
+        });
+        PrintRow("cout << endl", *histogram, 0);
+    }
+
+    {
+        SlowConsoleBuf buffer;
+        std::ostream console(&buffer);
+        auto logger = std::make_unique<AsyncLogger>();
+        logger->start(console);
+        auto histogram = std::make_unique<LatencyHistogram>();
+        RunBursts(bursts, *histogram, [&](bool on) {
+            logger->postToggle(LogMessage::PROFILING, on);
+        });
+        logger->stop();
+        PrintRow("AsyncLogger::post", *histogram, logger->droppedCount());
+    }
+    return 0;
+}
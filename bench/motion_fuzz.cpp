@@ -0,0 +1,248 @@
+// Fuzz-style check that mouse displacement is conserved end to end: random
+// deltas (including full-range 32-bit values) are pushed through the mouse
+// queue under overload, translated, and split into 16-bit HID-sized steps.
+// Exits non-zero on the first lost or invented count, or on a report that
+// comes out of the queue with a sequence not above its predecessor's. A
+// second pass runs the producer on its own thread, pausing at random so the
+// consumer takes coalesced motion while older reports are still queued, and
+// also checks that no report carries a button state it should not.
+//
+// Build: g++ -std=c++20 -O2 -pthread bench/motion_fuzz.cpp core/async_logger.cpp core/input_pipeline.cpp core/keycodes.cpp core/latency_histogram.cpp core/trace_recorder.cpp core/wake_signal.cpp -o motion_fuzz
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../core/input_pipeline.h"
+#include "../core/motion_split.h"
+#include "../core/ordered_drain.h"
+
+namespace {
+
+constexpr int32_t HID_MOTION_LIMIT = INT16_MAX;
+constexpr int32_t BOOT_MOTION_LIMIT = INT8_MAX;
+
+// Full-range values with the edges oversampled
+int32_t RandomDelta(std::mt19937_64& rng) {
+    switch (rng() % 8) {
+        case 0: return INT32_MAX;
+        case 1: return INT32_MIN;
+        case 2: return static_cast<int32_t>(rng());
+        case 3: return static_cast<int32_t>(rng() % 65536) - 32768;
+        default: return static_cast<int32_t>(rng() % 256) - 128;
+    }
+}
+
+bool CheckSplit(std::mt19937_64& rng, uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) {
+        int32_t dx = RandomDelta(rng);
+        int32_t dy = RandomDelta(rng);
+        int32_t limit = HID_MOTION_LIMIT;
+
+        // Boot-sized steps on full-range input would take millions of steps
+        if (i & 1) {
+            dx >>= 16;
+            dy >>= 16;
+            limit = BOOT_MOTION_LIMIT;
+        }
+
+        int64_t sumX = 0;
+        int64_t sumY = 0;
+        int64_t steps = 0;
+        bool inRange = true;
+        SplitMotion(dx, dy, limit, [&](int32_t x, int32_t y) {
+            inRange &= x >= -limit && x <= limit && y >= -limit && y <= limit;
+            sumX += x;
+            sumY += y;
+            steps++;
+        });
+
+        int64_t largest = std::max(std::llabs(dx), std::llabs(dy));
+        int64_t minimalSteps = (largest + limit - 1) / limit;
+        if (sumX != dx || sumY != dy || !inRange || steps != minimalSteps) {
+            std::printf("FAIL split (%d, %d) limit %d: sum (%lld, %lld) in %lld steps, minimal %lld%s\n",
+                        dx, dy, limit, static_cast<long long>(sumX), static_cast<long long>(sumY),
+                        static_cast<long long>(steps), static_cast<long long>(minimalSteps),
+                        inRange ? "" : ", step out of range");
+            return false;
+        }
+    }
+    std::printf("PASS split: %llu random displacements\n", static_cast<unsigned long long>(iterations));
+    return true;
+}
+
+// Bursts longer than the ring force coalescing; deltas stay small enough
+// that a burst's coalesced sum fits the 32-bit accumulator lanes
+bool CheckPipeline(std::mt19937_64& rng, uint64_t bursts) {
+    InputPipeline* pipeline = new InputPipeline();
+    OrderedReportDrain* drain = new OrderedReportDrain();
+    MouseReport lastState;
+    InputEvent events[MAX_EVENTS_PER_MOUSE_REPORT];
+    int64_t pushedX = 0, pushedY = 0;
+    int64_t injectedX = 0, injectedY = 0;
+    int64_t splitX = 0, splitY = 0;
+    bool splitInRange = true;
+    bool sequenceOrdered = true;
+    uint32_t lastSequence = 0;
+    uint8_t buttons = 0;
+
+    for (uint64_t b = 0; b < bursts; b++) {
+        size_t burst = 1 + rng() % (MouseQueue::capacity() * 8);
+        for (size_t i = 0; i < burst; i++) {
+            MouseReport report;
+            report.x = static_cast<int32_t>(rng() % (1u << 23)) - (1 << 22);
+            report.y = static_cast<int32_t>(rng() % (1u << 23)) - (1 << 22);
+            if (rng() % 16 == 0) buttons ^= MOUSE_BUTTON_LEFT;
+            if (rng() % 16 == 0) report.wheel = WHEEL_UNITS_PER_NOTCH;
+            report.buttons = buttons;
+            pushedX += report.x;
+            pushedY += report.y;
+            pipeline->pushMouse(report);
+        }
+
+        // Drain until the queue, carried reports and accumulator are empty
+        while (true) {
+            uint32_t watermark = pipeline->publishedSequence.load(std::memory_order_acquire);
+            size_t reports = drain->drain(
+                pipeline->mouseQueue, pipeline->keyboardQueue, pipeline->gamepadQueue, watermark,
+                [&](const MouseReport& report) {
+                    sequenceOrdered &= SequenceBefore(lastSequence, report.sequence);
+                    lastSequence = report.sequence;
+                    size_t count = TranslateMouseReport(report, lastState, 0, events);
+                    for (size_t e = 0; e < count; e++) {
+                        if (events[e].type != InputEventType::MOUSE_MOVE) continue;
+                        injectedX += events[e].dx;
+                        injectedY += events[e].dy;
+                        SplitMotion(events[e].dx, events[e].dy, HID_MOTION_LIMIT, [&](int32_t x, int32_t y) {
+                            splitInRange &= x >= -HID_MOTION_LIMIT && x <= HID_MOTION_LIMIT &&
+                                            y >= -HID_MOTION_LIMIT && y <= HID_MOTION_LIMIT;
+                            splitX += x;
+                            splitY += y;
+                        });
+                    }
+                },
+                [](const KeyboardReport&) {}, [](const GamepadReport&) {});
+            if (reports == 0 && pipeline->mouseQueue.isEmpty())
+                break;
+        }
+
+        if (injectedX != pushedX || injectedY != pushedY || splitX != pushedX || splitY != pushedY ||
+            !splitInRange || !sequenceOrdered) {
+            std::printf("FAIL pipeline burst %llu: pushed (%lld, %lld), injected (%lld, %lld), split (%lld, %lld)%s\n",
+                        static_cast<unsigned long long>(b),
+                        static_cast<long long>(pushedX), static_cast<long long>(pushedY),
+                        static_cast<long long>(injectedX), static_cast<long long>(injectedY),
+                        static_cast<long long>(splitX), static_cast<long long>(splitY),
+                        sequenceOrdered ? "" : ", sequence out of order");
+            delete drain;
+            delete pipeline;
+            return false;
+        }
+    }
+
+    std::printf("PASS pipeline: %llu bursts, %llu reports coalesced, %llu transitions dropped\n",
+                static_cast<unsigned long long>(bursts),
+                static_cast<unsigned long long>(pipeline->mouseQueue.coalescedCount()),
+                static_cast<unsigned long long>(pipeline->mouseQueue.droppedCount()));
+    delete drain;
+    delete pipeline;
+    return true;
+}
+
+// Reports go in from a second thread. Each delivered report must follow its
+// predecessor in sequence and carry either the buttons of the report with
+// its sequence or, when that report was a transition lost to overload, the
+// buttons already delivered.
+bool CheckConcurrent(std::mt19937_64& rng, uint64_t count) {
+    std::vector<MouseReport> reports(count);
+    uint8_t buttons = 0;
+    int64_t pushedX = 0, pushedY = 0;
+    for (MouseReport& report : reports) {
+        report.x = static_cast<int32_t>(rng() % 2048) - 1024;
+        report.y = static_cast<int32_t>(rng() % 2048) - 1024;
+        if (rng() % 16 == 0) buttons ^= 1 << (rng() % MOUSE_BUTTON_COUNT);
+        if (rng() % 32 == 0) report.wheel = WHEEL_UNITS_PER_NOTCH;
+        report.buttons = buttons;
+        pushedX += report.x;
+        pushedY += report.y;
+    }
+    std::vector<uint32_t> pauses(count);
+    for (uint32_t& pause : pauses)
+        pause = rng() % 64 == 0;
+
+    InputPipeline* pipeline = new InputPipeline();
+    OrderedReportDrain* drain = new OrderedReportDrain();
+    std::atomic<bool> done{false};
+
+    std::thread producer([&] {
+        for (size_t i = 0; i < reports.size(); i++) {
+            MouseReport report = reports[i];
+            pipeline->pushMouse(report);
+            if (pauses[i])
+                std::this_thread::yield();
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    int64_t deliveredX = 0, deliveredY = 0;
+    uint32_t lastSequence = 0;
+    uint8_t lastButtons = 0;
+    const char* failure = nullptr;
+    uint32_t failedSequence = 0;
+    while (true) {
+        bool finished = done.load(std::memory_order_acquire);
+        uint32_t watermark = pipeline->publishedSequence.load(std::memory_order_acquire);
+        size_t drained = drain->drain(
+            pipeline->mouseQueue, pipeline->keyboardQueue, pipeline->gamepadQueue, watermark,
+            [&](const MouseReport& report) {
+                if (failure)
+                    return;
+                const MouseReport& pushed = reports[report.sequence - 1];
+                if (!SequenceBefore(lastSequence, report.sequence))
+                    failure = "sequence out of order";
+                else if (report.buttons != pushed.buttons && report.buttons != lastButtons)
+                    failure = "stale button state";
+                failedSequence = report.sequence;
+                lastSequence = report.sequence;
+                lastButtons = report.buttons;
+                deliveredX += report.x;
+                deliveredY += report.y;
+            },
+            [](const KeyboardReport&) {}, [](const GamepadReport&) {});
+        if (failure || (finished && drained == 0 && pipeline->mouseQueue.isEmpty()))
+            break;
+    }
+    producer.join();
+
+    if (!failure && (deliveredX != pushedX || deliveredY != pushedY))
+        failure = "motion lost";
+    if (failure) {
+        std::printf("FAIL concurrent: %s at sequence %u, delivered (%lld, %lld) of (%lld, %lld)\n", failure,
+                    failedSequence, static_cast<long long>(deliveredX), static_cast<long long>(deliveredY),
+                    static_cast<long long>(pushedX), static_cast<long long>(pushedY));
+    } else {
+        std::printf("PASS concurrent: %llu reports, %llu coalesced, %llu transitions dropped\n",
+                    static_cast<unsigned long long>(count),
+                    static_cast<unsigned long long>(pipeline->mouseQueue.coalescedCount()),
+                    static_cast<unsigned long long>(pipeline->mouseQueue.droppedCount()));
+    }
+    delete drain;
+    delete pipeline;
+    return failure == nullptr;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint64_t seed = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1;
+    uint64_t iterations = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20000;
+    std::mt19937_64 rng(seed);
+
+    std::printf("Motion conservation fuzz, seed %llu\n", static_cast<unsigned long long>(seed));
+    bool ok = CheckSplit(rng, iterations) && CheckPipeline(rng, iterations) &&
+              CheckConcurrent(rng, iterations * 16);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+// 6KRO boot reports against NKRO bitmap reports: bytes queued per report,
+// capture-to-events cost through the ring and diff engine, and how many
+// reports lose held keys once more than six are down.
+//
+// Build: g++ -std=c++20 -O2 -pthread bench/nkro_bench.cpp core/async_logger.cpp core/input_pipeline.cpp core/keycodes.cpp core/latency_histogram.cpp core/trace_recorder.cpp core/wake_signal.cpp -o nkro_bench
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../core/input_pipeline.h"
+#include "../core/spsc_ring.h"
+#include "bench_util.h"
+
+namespace {
+
+constexpr size_t SEQUENCE_LENGTH = 4096;
+
+struct KeyTransition {
+    uint8_t usage;
+    bool down;
+};
+
+// Presses and releases that keep up to `maxHeld` keys down
+std::vector<KeyTransition> MakeTransitions(size_t maxHeld) {
+    std::mt19937 rng(7);
+    std::vector<KeyTransition> transitions;
+    std::vector<uint8_t> down;
+
+    transitions.reserve(SEQUENCE_LENGTH);
+    while (transitions.size() < SEQUENCE_LENGTH) {
+        if (down.size() == maxHeld || (!down.empty() && rng() % 2 == 0)) {
+            size_t index = rng() % down.size();
+            transitions.push_back({down[index], false});
+            down.erase(down.begin() + index);
+        } else {
+            uint8_t usage = static_cast<uint8_t>(0x04 + rng() % 0x60);
+            bool duplicate = false;
+            for (uint8_t d : down) duplicate |= d == usage;
+            if (duplicate) continue;
+            down.push_back(usage);
+            transitions.push_back({usage, true});
+        }
+    }
+    return transitions;
+}
+
+template <typename Report>
+void BenchFormat(const char* name, const std::vector<KeyTransition>& transitions, uint64_t passes) {
+    auto* ring = new SpscRing<Report, MAX_QUEUE_SIZE>();
+    InputEvent events[Report::MAX_TRANSITIONS];
+    Report lastState;
+    KeyBitmap captured;
+    KeyBitmap injected;
+    CacheMissCounter counter;
+    uint64_t eventCount = 0;
+    uint64_t wrongStates = 0;
+
+    counter.start();
+    uint64_t start = BenchNowNs();
+    for (uint64_t p = 0; p < passes; p++) {
+        for (const KeyTransition& transition : transitions) {
+            captured.assign(transition.usage, transition.down);
+
+            Report report;
+            report.setHeldKeys(captured);
+            ring->push(report);
+
+            Report dequeued;
+            ring->pop(dequeued);
+            size_t count = TranslateKeyboardReport(dequeued, lastState, 0, events);
+            eventCount += count;
+
+            for (size_t i = 0; i < count; i++) injected.assign(events[i].code, events[i].value != 0);
+            wrongStates += !(injected == captured);
+        }
+    }
+    uint64_t elapsed = BenchNowNs() - start;
+    uint64_t misses = counter.stop();
+
+    uint64_t reports = passes * transitions.size();
+    PrintBenchRow(name, reports, elapsed, counter, misses);
+    std::printf("%-36s %10zu bytes/report %6.2f events/report %6.2f%% reports missing keys\n", "",
+                sizeof(Report), static_cast<double>(eventCount) / reports,
+                100.0 * wrongStates / reports);
+    delete ring;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint64_t passes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000;
+
+    std::printf("Rollover benchmark, %llu passes over %zu transitions (push, pop and diff per report)\n",
+                static_cast<unsigned long long>(passes), SEQUENCE_LENGTH);
+
+    for (size_t maxHeld : {4, 6, 10}) {
+        std::vector<KeyTransition> transitions = MakeTransitions(maxHeld);
+
+        std::printf("\nup to %zu keys held\n", maxHeld);
+        BenchFormat<BootKeyboardReport>("6KRO boot report", transitions, passes);
+        BenchFormat<NkroKeyboardReport>("NKRO bitmap report", transitions, passes);
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+// Cost of capture-order merging against draining mouse then keyboard.
+//
+// Build: g++ -std=c++20 -O2 -pthread bench/ordering_bench.cpp core/async_logger.cpp core/latency_histogram.cpp core/wake_signal.cpp -o ordering_bench
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "../core/input_pipeline.h"
+#include "../core/ordered_drain.h"
+#include "bench_util.h"
+
+namespace {
+
+constexpr size_t BURST = 24;  // Reports queued between wakeups
+
+struct OrderCheck {
+    uint32_t last = 0;
+    uint64_t violations = 0;
+
+    void visit(uint32_t sequence) {
+        if (SequenceBefore(sequence, last)) violations++;
+        last = sequence;
+    }
+};
+
+// Queues a burst of interleaved reports, roughly 3:1 mouse to keyboard
+void FillBurst(InputPipeline& pipeline, std::mt19937& rng) {
+    for (size_t i = 0; i < BURST; i++) {
+        if (rng() % 4 != 0) {
+            MouseReport report;
+            report.x = 1;
+            pipeline.pushMouse(report);
+        } else {
+            KeyBitmap keys;
+            keys.set(0x04);
+            KeyboardReport report;
+            report.setHeldKeys(keys);
+            pipeline.pushKeyboard(report);
+        }
+    }
+}
+
+void BenchTwoRing(uint64_t bursts) {
+    InputPipeline* pipeline = new InputPipeline();
+    std::mt19937 rng(42);
+    MouseReport mouseBatch[MouseQueue::capacity() + 4];
+    KeyboardReport keyboardBatch[KeyboardQueue::capacity()];
+    OrderCheck check;
+    CacheMissCounter counter;
+    uint64_t reports = 0;
+    uint64_t drainNs = 0;
+
+    counter.start();
+    for (uint64_t b = 0; b < bursts; b++) {
+        FillBurst(*pipeline, rng);
+
+        uint64_t start = BenchNowNs();
+        size_t mouseCount = pipeline->mouseQueue.popBulk(mouseBatch);
+        for (size_t i = 0; i < mouseCount; i++) check.visit(mouseBatch[i].sequence);
+        size_t keyboardCount = pipeline->keyboardQueue.popBulk(keyboardBatch);
+        for (size_t i = 0; i < keyboardCount; i++) check.visit(keyboardBatch[i].sequence);
+        drainNs += BenchNowNs() - start;
+        reports += mouseCount + keyboardCount;
+    }
+    uint64_t misses = counter.stop();
+
+    PrintBenchRow("two rings, mouse then keyboard", reports, drainNs, counter, misses);
+    std::printf("%-36s %10llu out-of-order reports\n", "",
+                static_cast<unsigned long long>(check.violations));
+    delete pipeline;
+}
+
+void BenchOrdered(uint64_t bursts) {
+    InputPipeline* pipeline = new InputPipeline();
+    OrderedReportDrain* drain = new OrderedReportDrain();
+    std::mt19937 rng(42);
+    OrderCheck check;
+    CacheMissCounter counter;
+    uint64_t reports = 0;
+    uint64_t drainNs = 0;
+
+    counter.start();
+    for (uint64_t b = 0; b < bursts; b++) {
+        FillBurst(*pipeline, rng);
+
+        uint64_t start = BenchNowNs();
+        uint32_t watermark = pipeline->publishedSequence.load(std::memory_order_acquire);
+        reports += drain->drain(pipeline->mouseQueue, pipeline->keyboardQueue, pipeline->gamepadQueue,
+                                watermark,
+                                [&](const MouseReport& report) { check.visit(report.sequence); },
+                                [&](const KeyboardReport& report) { check.visit(report.sequence); },
+                                [&](const GamepadReport& report) { check.visit(report.sequence); });
+        drainNs += BenchNowNs() - start;
+    }
+    uint64_t misses = counter.stop();
+
+    PrintBenchRow("sequence-merged drain", reports, drainNs, counter, misses);
+    std::printf("%-36s %10llu out-of-order reports\n", "",
+                static_cast<unsigned long long>(check.violations));
+    delete drain;
+    delete pipeline;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint64_t bursts = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    std::printf("Ordering benchmark, %llu bursts of %zu reports (drain cost per report)\n\n",
+                static_cast<unsigned long long>(bursts), BURST);
+    BenchTwoRing(bursts);
+    BenchOrdered(bursts);
+    return 0;
+}
@@ -0,0 +1,63 @@
+// Pacing accuracy for trace replay at a steady 1 kHz: a relative sleep_for
+// of each inter-event gap, an absolute-deadline sleep alone, and the
+// absolute sleep with the final spin that TraceReplaySource uses. Reports
+// how late each event went out and how far the last one drifted.
+//
+// Build: g++ -std=c++20 -O2 -pthread bench/replay_bench.cpp core/latency_histogram.cpp core/trace_reader.cpp core/trace_replay.cpp core/wake_signal.cpp -o replay_bench
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+
+#include "../core/clock.h"
+#include "../core/latency_histogram.h"
+#include "../core/trace_replay.h"
+#include "bench_util.h"
+
+namespace {
+
+constexpr uint64_t PERIOD_NS = 1000000;
+
+void PrintRow(const char* name, const LatencyHistogram& lateness, int64_t driftNs) {
+    auto snapshot = std::make_unique<LatencyHistogram::Snapshot>();
+    lateness.snapshot(*snapshot);
+    std::printf("%-28s late p50 %8.1f us, p99 %8.1f us, max %8.1f us, final drift %9.1f us\n", name,
+                snapshot->percentile(50.0) / 1000.0, snapshot->percentile(99.0) / 1000.0,
+                snapshot->max / 1000.0, driftNs / 1000.0);
+}
+
+// Wait(i, startNs, deadlineNs) waits for event i by whatever means
+template <typename Wait>
+void Run(const char* name, int events, Wait&& wait) {
+    auto lateness = std::make_unique<LatencyHistogram>();
+    uint64_t startNs = MonotonicNanos();
+    int64_t lastLate = 0;
+    for (int i = 1; i <= events; i++) {
+        uint64_t deadlineNs = startNs + i * PERIOD_NS;
+        wait(deadlineNs);
+        uint64_t now = MonotonicNanos();
+        lastLate = static_cast<int64_t>(now - deadlineNs);
+        lateness->record(now > deadlineNs ? now - deadlineNs : 0);
+    }
+    PrintRow(name, *lateness, lastLate);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int events = argc > 1 ? std::atoi(argv[1]) : 2000;
+    std::printf("Replay pacing, %d events every %llu us\n", events,
+                static_cast<unsigned long long>(PERIOD_NS / 1000));
+
+    Run("relative sleep_for", events, [&](uint64_t) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(PERIOD_NS));
+    });
+    Run("absolute deadline", events, [&](uint64_t deadlineNs) {
+        SleepUntil(deadlineNs, 0);
+    });
+    Run("absolute deadline + spin", events, [&](uint64_t deadlineNs) {
+        SleepUntil(deadlineNs, static_cast<uint64_t>(std::chrono::nanoseconds(DEFAULT_REPLAY_SPIN).count()));
+    });
+    return 0;
+}
@@ -0,0 +1,173 @@
+// SpscRing vs. the original MouseQueue/KeyboardQueue structs. The mouse rows
+// use a bare SpscRing<MouseReport>: the pipeline's MouseQueue would fold the
+// bench's motionless reports away and the consumer would never see them.
+//
+// Build: g++ -std=c++20 -O2 -pthread bench/ring_bench.cpp -o ring_bench
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "../core/report_queue.h"
+#include "bench_util.h"
+
+namespace {
+
+using MouseRing = SpscRing<MouseReport, MAX_QUEUE_SIZE>;
+
+// The pre-SpscRing queue: modulo indexing, head/tail on one cache line
+template <typename T>
+struct LegacyQueue {
+    T reports[MAX_QUEUE_SIZE];
+    std::atomic<size_t> head{0};
+    std::atomic<size_t> tail{0};
+
+    bool push(const T& report) {
+        size_t current_tail = tail.load(std::memory_order_relaxed);
+        size_t next_tail = (current_tail + 1) % MAX_QUEUE_SIZE;
+        if (next_tail == head.load(std::memory_order_acquire))
+            return false;  // Queue is full
+
+        reports[current_tail] = report;
+        tail.store(next_tail, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& report) {
+        size_t current_head = head.load(std::memory_order_relaxed);
+        if (current_head == tail.load(std::memory_order_acquire))
+            return false;  // Queue is empty
+
+        report = reports[current_head];
+        head.store((current_head + 1) % MAX_QUEUE_SIZE, std::memory_order_release);
+        return true;
+    }
+};
+
+// Push/pop pairs on one thread: the raw per-operation cost
+template <typename Queue, typename Report>
+void BenchSameThread(const char* name, uint64_t iterations) {
+    Queue* queue = new Queue();
+    Report report;
+    CacheMissCounter counter;
+
+    counter.start();
+    uint64_t start = BenchNowNs();
+    for (uint64_t i = 0; i < iterations; i++) {
+        report.timestamp = static_cast<uint32_t>(i);
+        queue->push(report);
+        queue->pop(report);
+        DoNotOptimize(report);
+    }
+    uint64_t elapsed = BenchNowNs() - start;
+    uint64_t misses = counter.stop();
+
+    PrintBenchRow(name, iterations * 2, elapsed, counter, misses);
+    delete queue;
+}
+
+// Producer and consumer on separate cores: the cross-core handoff cost
+template <typename Queue, typename Report>
+void BenchCrossThread(const char* name, uint64_t iterations) {
+    Queue* queue = new Queue();
+    CacheMissCounter counter;
+    std::atomic<bool> go{false};
+
+    counter.start();
+    std::thread consumer([&] {
+        PinToCpu(1);
+        while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+        Report report;
+        uint64_t received = 0;
+        while (received < iterations) {
+            if (queue->pop(report)) {
+                DoNotOptimize(report);
+                received++;
+            } else {
+                std::this_thread::yield();  // Keeps single-core hosts moving
+            }
+        }
+    });
+
+    PinToCpu(0);
+    uint64_t start = BenchNowNs();
+    go.store(true, std::memory_order_release);
+    Report report;
+    for (uint64_t i = 0; i < iterations; i++) {
+        report.timestamp = static_cast<uint32_t>(i);
+        while (!queue->push(report)) std::this_thread::yield();
+    }
+    consumer.join();
+    uint64_t elapsed = BenchNowNs() - start;
+    uint64_t misses = counter.stop();
+
+    PrintBenchRow(name, iterations, elapsed, counter, misses);
+    delete queue;
+}
+
+// Producer pushes one report at a time, consumer drains with popBulk
+template <typename Report>
+void BenchCrossThreadBulk(const char* name, uint64_t iterations) {
+    using Queue = SpscRing<Report, MAX_QUEUE_SIZE>;
+    Queue* queue = new Queue();
+    CacheMissCounter counter;
+    std::atomic<bool> go{false};
+
+    counter.start();
+    std::thread consumer([&] {
+        PinToCpu(1);
+        while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+        Report batch[MAX_QUEUE_SIZE];
+        uint64_t received = 0;
+        while (received < iterations) {
+            size_t count = queue->popBulk(batch);
+            if (count > 0) {
+                DoNotOptimize(batch);
+                received += count;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    PinToCpu(0);
+    uint64_t start = BenchNowNs();
+    go.store(true, std::memory_order_release);
+    Report report;
+    for (uint64_t i = 0; i < iterations; i++) {
+        report.timestamp = static_cast<uint32_t>(i);
+        while (!queue->push(report)) std::this_thread::yield();
+    }
+    consumer.join();
+    uint64_t elapsed = BenchNowNs() - start;
+    uint64_t misses = counter.stop();
+
+    PrintBenchRow(name, iterations, elapsed, counter, misses);
+    delete queue;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint64_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+    std::printf("Ring benchmark, %llu iterations, capacity %zu\n",
+                static_cast<unsigned long long>(iterations), MAX_QUEUE_SIZE);
+
+    std::printf("\n-- same thread (push+pop) --\n");
+    BenchSameThread<LegacyQueue<MouseReport>, MouseReport>("legacy MouseQueue", iterations);
+    BenchSameThread<MouseRing, MouseReport>("SpscRing<MouseReport>", iterations);
+    BenchSameThread<LegacyQueue<KeyboardReport>, KeyboardReport>("legacy KeyboardQueue", iterations);
+    BenchSameThread<KeyboardQueue, KeyboardReport>("SpscRing<KeyboardReport>", iterations);
+
+    std::printf("\n-- cross thread (per report) --\n");
+    BenchCrossThread<LegacyQueue<MouseReport>, MouseReport>("legacy MouseQueue", iterations);
+    BenchCrossThread<MouseRing, MouseReport>("SpscRing<MouseReport>", iterations);
+    BenchCrossThread<LegacyQueue<KeyboardReport>, KeyboardReport>("legacy KeyboardQueue", iterations);
+    BenchCrossThread<KeyboardQueue, KeyboardReport>("SpscRing<KeyboardReport>", iterations);
+    BenchCrossThreadBulk<MouseReport>("SpscRing<MouseReport> popBulk", iterations);
+    BenchCrossThreadBulk<KeyboardReport>("SpscRing<KeyboardReport> popBulk", iterations);
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+// Cost of tracing a report on the processing thread: a buffered fwrite per
+// report against TraceRecorder::record, which fills a block and leaves the
+// write to another thread. Reports arrive in 1 ms bursts, far above any
+// real device rate. Afterwards the trace is mapped with TraceReader and
+// checked record by record; exits non-zero on any mismatch.
+//
+// Build: g++ -std=c++20 -O2 -pthread bench/trace_bench.cpp core/latency_histogram.cpp core/trace_reader.cpp core/trace_recorder.cpp core/wake_signal.cpp -o trace_bench
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../core/clock.h"
+#include "../core/latency_histogram.h"
+#include "../core/trace_reader.h"
+#include "../core/trace_recorder.h"
+#include "bench_util.h"
+
+namespace {
+
+constexpr size_t REPORTS_PER_BURST = 256;
+
+struct Source {
+    HIDReportType type;
+    MouseReport mouse;
+    KeyboardReport keyboard;
+    GamepadReport gamepad;
+};
+
+// Mostly motion, with a key change every 16 reports and a pad frame every 64
+std::vector<Source> MakeReports(size_t count) {
+    std::vector<Source> reports(count);
+    for (size_t i = 0; i < count; i++) {
+        Source& source = reports[i];
+        uint64_t timestamp = 1000000 + i * 1000;
+        uint32_t sequence = static_cast<uint32_t>(i + 1);
+        if (i % 64 == 63) {
+            source.type = HIDReportType::GAMEPAD;
+            source.gamepad.timestamp = timestamp;
+            source.gamepad.sequence = sequence;
+            source.gamepad.device = 3;
+            source.gamepad.sticks[0] = static_cast<int16_t>(i);
+            source.gamepad.buttons = static_cast<uint32_t>(i);
+        } else if (i % 16 == 15) {
+            source.type = HIDReportType::KEYBOARD;
+            source.keyboard.timestamp = timestamp;
+            source.keyboard.sequence = sequence;
+            source.keyboard.device = 2;
+            KeyBitmap held;
+            held.set(static_cast<uint8_t>(4 + i % 26));
+            source.keyboard.setHeldKeys(held);
+        } else {
+            source.type = HIDReportType::MOUSE;
+            source.mouse.timestamp = timestamp;
+            source.mouse.sequence = sequence;
+            source.mouse.device = 1;
+            source.mouse.x = static_cast<int32_t>(i % 7) - 3;
+            source.mouse.y = static_cast<int32_t>(i % 5) - 2;
+            source.mouse.buttons = (i / 100) & 1;
+        }
+    }
+    return reports;
+}
+
+template <typename Record>
+void RunBursts(const std::vector<Source>& reports, LatencyHistogram& histogram, Record&& record) {
+    for (size_t i = 0; i < reports.size(); i++) {
+        const Source& source = reports[i];
+        uint64_t start = MonotonicNanos();
+        if (source.type == HIDReportType::MOUSE)
+            record(source.mouse, start);
+        else if (source.type == HIDReportType::KEYBOARD)
+            record(source.keyboard, start);
+        else
+            record(source.gamepad, start);
+        histogram.record(MonotonicNanos() - start);
+        if (i % REPORTS_PER_BURST == REPORTS_PER_BURST - 1)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void PrintRow(const char* name, const LatencyHistogram& histogram, uint64_t dropped) {
+    auto snapshot = std::make_unique<LatencyHistogram::Snapshot>();
+    histogram.snapshot(*snapshot);
+    std::printf("%-28s p50 %8.3f us, p99 %8.3f us, max %8.2f us, %llu dropped\n", name,
+                snapshot->percentile(50.0) / 1000.0, snapshot->percentile(99.0) / 1000.0,
+                snapshot->max / 1000.0, static_cast<unsigned long long>(dropped));
+}
+
+bool Verify(const char* path, const std::vector<Source>& reports) {
+    TraceReader reader;
+    if (!reader.open(path))
+        return false;
+    if (!reader.complete() || reader.recordCount() != reports.size()) {
+        std::printf("FAIL: %zu records read, %zu written\n", reader.recordCount(), reports.size());
+        return false;
+    }
+
+    for (size_t i = 0; i < reports.size(); i++) {
+        const Source& source = reports[i];
+        const TraceRecord& record = reader.records()[i];
+        bool same = record.type == static_cast<uint8_t>(source.type);
+        if (same && source.type == HIDReportType::MOUSE) {
+            MouseReport decoded = DecodeTraceMouse(record);
+            same = decoded.x == source.mouse.x && decoded.y == source.mouse.y &&
+                   decoded.buttons == source.mouse.buttons && decoded.device == source.mouse.device &&
+                   decoded.timestamp == source.mouse.timestamp;
+        } else if (same && source.type == HIDReportType::KEYBOARD) {
+            KeyboardReport decoded = DecodeTraceKeyboard(record);
+            same = decoded.heldKeys() == source.keyboard.heldKeys() &&
+                   decoded.sequence == source.keyboard.sequence;
+        } else if (same) {
+            GamepadReport decoded = DecodeTraceGamepad(record);
+            same = decoded.sticks[0] == source.gamepad.sticks[0] &&
+                   decoded.buttons == source.gamepad.buttons && decoded.hat == source.gamepad.hat;
+        }
+        if (!same) {
+            std::printf("FAIL: record %zu differs from the report written\n", i);
+            return false;
+        }
+    }
+
+    // Seeking lands on the first record at or after the time asked for
+    size_t middle = reports.size() / 2 + 3;
+    size_t found = reader.seek(reader.records()[middle].captureNs);
+    if (found != middle || reader.seek(reader.records()[middle].captureNs - 1) != middle) {
+        std::printf("FAIL: seek found record %zu, expected %zu\n", found, middle);
+        return false;
+    }
+
+    std::printf("verified %zu records, %llu index entries\n", reader.recordCount(),
+                static_cast<unsigned long long>(reader.header().indexCount));
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 256 * 1024;
+    const char* path = argc > 2 ? argv[2] : "trace_bench.trace";
+    std::vector<Source> reports = MakeReports(count);
+
+    std::printf("Tracing %zu reports in bursts of %zu per ms, %zu-byte records\n", count,
+                REPORTS_PER_BURST, sizeof(TraceRecord));
+
+    {
+        std::FILE* file = std::fopen(path, "wb");
+        if (!file) {
+            std::perror(path);
+            return 1;
+        }
+        auto histogram = std::make_unique<LatencyHistogram>();
+        RunBursts(reports, *histogram, [&](const auto& report, uint64_t dequeueNs) {
+            TraceRecord record;
+            EncodeTraceRecord(report, dequeueNs, record);
+            std::fwrite(&record, sizeof(record), 1, file);
+        });
+        std::fclose(file);
+        PrintRow("fwrite per report", *histogram, 0);
+    }
+
+    bool ok;
+    {
+        TraceRecorder recorder(path);
+        if (!recorder.open())
+            return 1;
+        auto histogram = std::make_unique<LatencyHistogram>();
+        RunBursts(reports, *histogram, [&](const auto& report, uint64_t dequeueNs) {
+            recorder.record(report, dequeueNs);
+        });
+        recorder.close();
+        PrintRow("TraceRecorder::record", *histogram, recorder.droppedRecords());
+        ok = recorder.droppedRecords() == 0 && Verify(path, reports);
+    }
+
+    std::remove(path);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,260 @@
+// Mouse report translation and evdev event fill: the original if-chain
+// translator with per-field event construction against the table-driven
+// translator and UinputSink's template copies. Reports button-heavy and
+// motion-heavy streams and checks both translators emit the same events.
+// Linux only (links the uinput sink; no device is opened, so nothing is
+// written).
+//
+// Build: g++ -std=c++20 -O2 -pthread bench/translate_bench.cpp core/async_logger.cpp core/input_pipeline.cpp core/keycodes.cpp core/latency_histogram.cpp core/trace_recorder.cpp core/wake_signal.cpp backends/linux/uinput_sink.cpp -o translate_bench
+
+#include <linux/input.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "../backends/linux/uinput_sink.h"
+#include "../core/input_pipeline.h"
+#include "bench_util.h"
+
+namespace {
+
+constexpr size_t SEQUENCE_LENGTH = 4096;
+
+InputEvent LegacyButtonEvent(uint8_t button, bool down) {
+    InputEvent event{};
+    event.type = InputEventType::MOUSE_BUTTON;
+    event.code = button;
+    event.value = down ? 1 : 0;
+    return event;
+}
+
+// Original translator: one block per button, events built field by field
+__attribute__((noinline)) size_t LegacyTranslateMouseReport(const MouseReport& report, MouseReport& lastState,
+                                  uint64_t dequeueNs, InputEvent* out) {
+    size_t count = 0;
+
+    if (report.x != 0 || report.y != 0) {
+        InputEvent& event = out[count++];
+        event = InputEvent{};
+        event.type = InputEventType::MOUSE_MOVE;
+        event.dx = report.x;
+        event.dy = report.y;
+    }
+
+    uint8_t changedButtons = report.buttons ^ lastState.buttons;
+    if (changedButtons & MOUSE_BUTTON_LEFT)
+        out[count++] = LegacyButtonEvent(MOUSE_BUTTON_LEFT, report.buttons & MOUSE_BUTTON_LEFT);
+    if (changedButtons & MOUSE_BUTTON_RIGHT)
+        out[count++] = LegacyButtonEvent(MOUSE_BUTTON_RIGHT, report.buttons & MOUSE_BUTTON_RIGHT);
+    if (changedButtons & MOUSE_BUTTON_MIDDLE)
+        out[count++] = LegacyButtonEvent(MOUSE_BUTTON_MIDDLE, report.buttons & MOUSE_BUTTON_MIDDLE);
+    if (changedButtons & MOUSE_BUTTON_X1)
+        out[count++] = LegacyButtonEvent(MOUSE_BUTTON_X1, report.buttons & MOUSE_BUTTON_X1);
+    if (changedButtons & MOUSE_BUTTON_X2)
+        out[count++] = LegacyButtonEvent(MOUSE_BUTTON_X2, report.buttons & MOUSE_BUTTON_X2);
+
+    if (report.wheel != 0) {
+        InputEvent& event = out[count++];
+        event = InputEvent{};
+        event.type = InputEventType::MOUSE_WHEEL;
+        event.value = report.wheel;
+    }
+    if (report.hwheel != 0) {
+        InputEvent& event = out[count++];
+        event = InputEvent{};
+        event.type = InputEventType::MOUSE_HWHEEL;
+        event.value = report.hwheel;
+    }
+
+    lastState = report;
+    for (size_t i = 0; i < count; i++) {
+        out[i].captureNs = report.timestamp;
+        out[i].dequeueNs = dequeueNs;
+    }
+    return count;
+}
+
+uint16_t LegacyButtonCode(uint8_t button) {
+    switch (button) {
+        case MOUSE_BUTTON_LEFT:   return BTN_LEFT;
+        case MOUSE_BUTTON_RIGHT:  return BTN_RIGHT;
+        case MOUSE_BUTTON_MIDDLE: return BTN_MIDDLE;
+        case MOUSE_BUTTON_X1:     return BTN_SIDE;
+        case MOUSE_BUTTON_X2:     return BTN_EXTRA;
+        default:                  return 0;
+    }
+}
+
+void LegacyAppend(input_event* buffer, size_t& count, uint16_t type, uint16_t code, int32_t value) {
+    input_event& event = buffer[count++];
+    memset(&event, 0, sizeof(event));
+    event.type = type;
+    event.code = code;
+    event.value = value;
+}
+
+#ifdef REL_WHEEL_HI_RES
+constexpr uint16_t WHEEL_HI_RES_AXIS = REL_WHEEL_HI_RES;
+constexpr uint16_t HWHEEL_HI_RES_AXIS = REL_HWHEEL_HI_RES;
+#else
+constexpr uint16_t WHEEL_HI_RES_AXIS = 0;
+constexpr uint16_t HWHEEL_HI_RES_AXIS = 0;
+#endif
+
+// Original UinputSink::send, with a switch for the button code and a
+// memset plus field stores per evdev event; no device, so nothing is written
+class LegacyUinputSink : public InputSink {
+public:
+    const char* name() const override { return "legacy-uinput"; }
+    bool open() override { return true; }
+    void close() override {}
+
+    __attribute__((noinline)) size_t send(const InputEvent* events, size_t count) override {
+        size_t sent = 0;
+        while (sent < count) {
+            size_t eventCount = 0;
+            for (size_t batched = 0; sent < count && batched < UinputSink::MAX_BATCH; sent++, batched++) {
+                const InputEvent& event = events[sent];
+                switch (event.type) {
+                    case InputEventType::MOUSE_MOVE:
+                        if (event.dx != 0) LegacyAppend(m_eventBuffer, eventCount, EV_REL, REL_X, event.dx);
+                        if (event.dy != 0) LegacyAppend(m_eventBuffer, eventCount, EV_REL, REL_Y, event.dy);
+                        break;
+                    case InputEventType::MOUSE_BUTTON:
+                        LegacyAppend(m_eventBuffer, eventCount, EV_KEY, LegacyButtonCode(event.code), event.value);
+                        break;
+                    case InputEventType::MOUSE_WHEEL:
+                        appendWheel(eventCount, REL_WHEEL, WHEEL_HI_RES_AXIS, m_wheelRemainder, event.value);
+                        break;
+                    case InputEventType::MOUSE_HWHEEL:
+                        appendWheel(eventCount, REL_HWHEEL, HWHEEL_HI_RES_AXIS, m_hwheelRemainder, event.value);
+                        break;
+                    default:
+                        continue;
+                }
+                LegacyAppend(m_eventBuffer, eventCount, EV_SYN, SYN_REPORT, 0);
+            }
+            DoNotOptimize(m_eventBuffer[0]);
+        }
+        return count;
+    }
+
+private:
+    void appendWheel(size_t& eventCount, uint16_t axis, uint16_t hiResAxis, int32_t& remainder, int32_t value) {
+        if (hiResAxis != 0)
+            LegacyAppend(m_eventBuffer, eventCount, EV_REL, hiResAxis, value);
+        remainder += value;
+        int32_t notches = remainder / WHEEL_UNITS_PER_NOTCH;
+        if (notches != 0) {
+            LegacyAppend(m_eventBuffer, eventCount, EV_REL, axis, notches);
+            remainder -= notches * WHEEL_UNITS_PER_NOTCH;
+        }
+    }
+
+    int32_t m_wheelRemainder = 0;
+    int32_t m_hwheelRemainder = 0;
+    input_event m_eventBuffer[UinputSink::MAX_BATCH * 4];
+};
+
+// Reports with motion, with `buttonPercent` of them flipping one to three
+// buttons and a few wheel detents
+std::vector<MouseReport> MakeReports(unsigned buttonPercent) {
+    std::mt19937 rng(11);
+    std::vector<MouseReport> reports(SEQUENCE_LENGTH);
+    uint8_t buttons = 0;
+
+    for (MouseReport& report : reports) {
+        report.x = static_cast<int32_t>(rng() % 21) - 10;
+        report.y = static_cast<int32_t>(rng() % 21) - 10;
+        if (rng() % 100 < buttonPercent) {
+            for (unsigned flips = 1 + rng() % 3; flips > 0; flips--)
+                buttons ^= static_cast<uint8_t>(1u << (rng() % MOUSE_BUTTON_COUNT));
+        }
+        if (rng() % 20 == 0)
+            report.wheel = WHEEL_UNITS_PER_NOTCH;
+        report.buttons = buttons;
+    }
+    return reports;
+}
+
+// Translates every report and hands its events to the sink, as the
+// processing loop does
+template <typename Translate>
+void RunRow(const char* name, const std::vector<MouseReport>& reports, uint64_t passes,
+            Translate&& translate, InputSink& sink) {
+    InputEvent events[MAX_EVENTS_PER_MOUSE_REPORT];
+    CacheMissCounter counter;
+    MouseReport lastState;
+    uint64_t eventCount = 0;
+    uint64_t total = passes * reports.size();
+
+    counter.start();
+    uint64_t start = BenchNowNs();
+    for (uint64_t p = 0; p < passes; p++) {
+        for (const MouseReport& report : reports) {
+            size_t count = translate(report, lastState, events);
+            eventCount += sink.send(events, count);
+        }
+    }
+    uint64_t elapsed = BenchNowNs() - start;
+    uint64_t misses = counter.stop();
+
+    PrintBenchRow(name, total, elapsed, counter, misses);
+    std::printf("%-36s %10.1f M reports/s %6.2f events/report\n", "",
+                elapsed ? total * 1000.0 / elapsed : 0.0, static_cast<double>(eventCount) / total);
+}
+
+void BenchStream(const char* label, const std::vector<MouseReport>& reports, uint64_t passes) {
+    InputEvent events[MAX_EVENTS_PER_MOUSE_REPORT];
+    InputEvent legacyEvents[MAX_EVENTS_PER_MOUSE_REPORT];
+    auto* legacySink = new LegacyUinputSink();
+    auto* sink = new UinputSink();
+    uint64_t mismatches = 0;
+    DoNotOptimize(legacySink);
+    DoNotOptimize(sink);
+
+    // Same events from both translators, or the comparison is meaningless
+    MouseReport lastLegacy, lastTable;
+    for (const MouseReport& report : reports) {
+        size_t legacyCount = LegacyTranslateMouseReport(report, lastLegacy, 0, legacyEvents);
+        size_t count = TranslateMouseReport(report, lastTable, 0, events);
+        mismatches += count != legacyCount;
+        for (size_t i = 0; i < count && i < legacyCount; i++) {
+            mismatches += events[i].type != legacyEvents[i].type || events[i].code != legacyEvents[i].code ||
+                          events[i].value != legacyEvents[i].value || events[i].dx != legacyEvents[i].dx ||
+                          events[i].dy != legacyEvents[i].dy || events[i].captureNs != legacyEvents[i].captureNs;
+        }
+    }
+
+    std::printf("\n%s (%llu translator mismatches)\n", label, static_cast<unsigned long long>(mismatches));
+    RunRow("if-chain + per-field fill", reports, passes,
+           [](const MouseReport& report, MouseReport& lastState, InputEvent* out) {
+               return LegacyTranslateMouseReport(report, lastState, 0, out);
+           },
+           *legacySink);
+    RunRow("ctz table + template fill", reports, passes,
+           [](const MouseReport& report, MouseReport& lastState, InputEvent* out) {
+               return TranslateMouseReport(report, lastState, 0, out);
+           },
+           *sink);
+
+    delete sink;
+    delete legacySink;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint64_t passes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000;
+
+    std::printf("Mouse translation benchmark, %llu passes over %zu reports (translate and evdev fill)\n",
+                static_cast<unsigned long long>(passes), SEQUENCE_LENGTH);
+
+    BenchStream("motion, 5% button changes", MakeReports(5), passes);
+    BenchStream("motion, 50% button changes", MakeReports(50), passes);
+    BenchStream("motion, every report changes buttons", MakeReports(100), passes);
+    return 0;
+}
@@ -0,0 +1,71 @@
+// Wake latency of each WaitMode: time from a producer publishing a report
+// to the parked/spinning consumer observing it.
+//
+// Build: g++ -std=c++20 -O2 -pthread bench/wake_bench.cpp core/wake_signal.cpp -o wake_bench
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../core/wake_signal.h"
+#include "bench_util.h"
+
+namespace {
+
+void BenchMode(WaitMode mode, int samples) {
+    WakeSignal signal;
+    std::atomic<uint32_t> published{0};
+    std::atomic<uint64_t> stampNs{0};
+    std::vector<uint64_t> latencies;
+    latencies.reserve(samples);
+
+    std::thread consumer([&] {
+        PinToCpu(1);
+        uint32_t seen = 0;
+        while (static_cast<int>(seen) < samples) {
+            bool ready = signal.wait(mode, DEFAULT_SPIN_BUDGET, std::chrono::milliseconds(100), [&] {
+                return published.load(std::memory_order_acquire) != seen;
+            });
+            if (!ready) continue;
+            uint64_t now = BenchNowNs();
+            latencies.push_back(now - stampNs.load(std::memory_order_relaxed));
+            seen = published.load(std::memory_order_acquire);
+        }
+    });
+
+    PinToCpu(0);
+    std::mt19937 rng(7);
+    for (int i = 0; i < samples; i++) {
+        // Random gaps so the consumer regularly runs out of spin budget
+        std::this_thread::sleep_for(std::chrono::microseconds(200 + rng() % 1800));
+        stampNs.store(BenchNowNs(), std::memory_order_relaxed);
+        published.fetch_add(1, std::memory_order_release);
+        signal.notify();
+    }
+    consumer.join();
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) {
+        return latencies[std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()))] / 1000.0;
+    };
+    std::printf("%-8s p50 %9.1f us  p99 %9.1f us  max %9.1f us\n", WaitModeName(mode),
+                percentile(0.50), percentile(0.99), latencies.back() / 1000.0);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int samples = argc > 1 ? std::atoi(argv[1]) : 2000;
+
+    std::printf("Wake latency, %d samples per mode, %lld us spin budget\n\n", samples,
+                static_cast<long long>(std::chrono::microseconds(DEFAULT_SPIN_BUDGET).count()));
+    BenchMode(WaitMode::POLL, samples);
+    BenchMode(WaitMode::SPIN, samples);
+    BenchMode(WaitMode::BLOCK, samples);
+    BenchMode(WaitMode::HYBRID, samples);
+    return 0;
+}
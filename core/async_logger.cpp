@@ -0,0 +1,112 @@
+#include "async_logger.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// How long queued records may wait before the writer picks them up.
+// Producers never signal the writer, so this is also its polling period.
+constexpr auto WRITE_INTERVAL = std::chrono::milliseconds(20);
+
+// Keep the writer out of the way of the capture and processing threads
+void LowerThreadPriority() {
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#else
+    // Linux nice values are per thread
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+#endif
+}
+
+}  // namespace
+
+AsyncLogger::~AsyncLogger() {
+    stop();
+}
+
+void AsyncLogger::start(std::ostream& out) {
+    m_out = &out;
+    m_stop.store(false, std::memory_order_relaxed);
+    m_thread = std::thread(&AsyncLogger::run, this);
+}
+
+void AsyncLogger::stop() {
+    if (m_thread.joinable()) {
+        m_stop.store(true, std::memory_order_release);
+        m_wake.notify();
+        m_thread.join();
+    }
+}
+
+void AsyncLogger::run() {
+    LowerThreadPriority();
+
+    uint64_t reportedDrops = 0;
+    for (;;) {
+        // Read the flag first so the final pass sees every record posted
+        // before stop()
+        bool stopping = m_stop.load(std::memory_order_acquire);
+
+        LogRecord record;
+        bool wrote = false;
+        while (m_ring.pop(record)) {
+            write(record);
+            wrote = true;
+        }
+
+        uint64_t drops = droppedCount();
+        if (drops != reportedDrops) {
+            *m_out << (drops - reportedDrops) << " log messages dropped\n";
+            reportedDrops = drops;
+            wrote = true;
+        }
+
+        if (wrote)
+            m_out->flush();
+        if (stopping)
+            break;
+
+        m_wake.wait(WaitMode::BLOCK, std::chrono::nanoseconds(0), WRITE_INTERVAL,
+                    [&] { return m_stop.load(std::memory_order_relaxed); });
+    }
+}
+
+void AsyncLogger::write(const LogRecord& record) {
+    std::ostream& out = *m_out;
+    switch (record.message) {
+        case LogMessage::INPUT_BLOCKING:
+            out << "Input blocking: " << (record.enabled ? "ON" : "OFF") << "\n";
+            break;
+        case LogMessage::PROFILING:
+            out << "Profiling: " << (record.enabled ? "ON" : "OFF") << "\n";
+            break;
+        case LogMessage::EXITING:
+            out << "Exiting...\n";
+            break;
+        case LogMessage::SINK_REJECTED:
+            out << "Output device rejected " << record.count << " events\n";
+            break;
+        case LogMessage::PERFORMANCE: {
+            const LogRecord::Performance& perf = record.performance;
+            out << "Performance: " << perf.fps << " fps, "
+                << perf.eventsPerSec << " events/sec, "
+                << perf.coalesced << " coalesced, "
+                << perf.dropped << " dropped, "
+                << "batch target " << perf.batchTarget << "\n";
+            break;
+        }
+        case LogMessage::PROFILE_REPORT: {
+            const LogRecord::Histograms& histograms = record.histograms;
+            histograms.latency->print(out);
+            histograms.injection->print(out);
+            PrintLatency(out, "Capture callback", *histograms.captureCallback);
+            break;
+        }
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <ostream>
+#include <stdint.h>
+#include <thread>
+
+#include "latency_histogram.h"
+#include "mpsc_ring.h"
+#include "wake_signal.h"
+
+// Messages the capture and processing threads report while running
+enum class LogMessage : uint8_t {
+    INPUT_BLOCKING,   // enabled
+    PROFILING,        // enabled
+    EXITING,
+    PERFORMANCE,      // performance
+    PROFILE_REPORT,   // histograms
+    SINK_REJECTED,    // count
+};
+
+// Fixed-size binary log record. Only the message id and raw values are
+// captured; the text is produced on the logger thread.
+struct LogRecord {
+    struct Performance {
+        double fps;
+        double eventsPerSec;
+        uint64_t coalesced;
+        uint64_t dropped;
+        uint32_t batchTarget;
+    };
+
+    // Long-lived histograms, snapshot and printed by the logger thread
+    struct Histograms {
+        const PipelineLatency* latency;
+        const InjectionStats* injection;
+        const LatencyHistogram* captureCallback;
+    };
+
+    LogMessage message;
+    union {
+        bool enabled;
+        uint64_t count;
+        Performance performance;
+        Histograms histograms;
+    };
+};
+
+// Lock-free asynchronous logger. Any thread may post() a record without
+// blocking or touching the console; a low-priority thread formats and
+// writes them. Records posted while the ring is full are dropped and
+// counted.
+class AsyncLogger {
+public:
+    static constexpr size_t RING_SIZE = 256;
+
+    ~AsyncLogger();
+
+    // Launches the writer thread
+    void start(std::ostream& out);
+    // Writes whatever is still queued, then joins the writer thread
+    void stop();
+
+    bool post(const LogRecord& record) {
+        if (m_ring.push(record))
+            return true;
+        m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    bool postMessage(LogMessage message) {
+        LogRecord record{};
+        record.message = message;
+        return post(record);
+    }
+
+    bool postToggle(LogMessage message, bool enabled) {
+        LogRecord record{};
+        record.message = message;
+        record.enabled = enabled;
+        return post(record);
+    }
+
+    uint64_t droppedCount() const { return m_droppedCount.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+    void write(const LogRecord& record);
+
+    MpscRing<LogRecord, RING_SIZE> m_ring;
+    std::atomic<uint64_t> m_droppedCount{0};
+
+    std::ostream* m_out = nullptr;
+    WakeSignal m_wake;  // Only stop() wakes the writer early
+    std::thread m_thread;
+    std::atomic<bool> m_stop{false};
+};
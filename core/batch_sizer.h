@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "input_backend.h"
+
+// When the processing thread hands its buffered events to the sink. Only
+// whole reports are ever buffered, so a report is never split across two
+// injection calls.
+struct BatchPolicy {
+    size_t minEvents = 16;                  // Target while input is sparse
+    size_t maxEvents = MAX_INJECT_BATCH;    // Largest target under a burst
+    // Longest an event may sit in the buffer after its dequeue before the
+    // batch goes out regardless of size
+    std::chrono::nanoseconds latencyBudget = std::chrono::microseconds(250);
+};
+
+// Adapts the flush target to the load: it doubles while drains produce
+// more events than it allows and halves once they fall well below it, so
+// bursts go out in a few large writes and sparse input in small ones.
+class BatchSizer {
+public:
+    explicit BatchSizer(const BatchPolicy& policy)
+        : m_maxEvents(std::clamp<size_t>(policy.maxEvents, 1, MAX_INJECT_BATCH)),
+          m_minEvents(std::clamp<size_t>(policy.minEvents, 1, m_maxEvents)),
+          m_budgetNs(static_cast<uint64_t>(policy.latencyBudget.count())),
+          m_target(m_minEvents) {}
+
+    size_t target() const { return m_target; }
+
+    // True once `buffered` events reach the target, or the oldest of them
+    // (dequeued at oldestDequeueNs) has used up the latency budget by nowNs
+    bool shouldFlush(size_t buffered, uint64_t oldestDequeueNs, uint64_t nowNs) const {
+        if (buffered == 0)
+            return false;
+        if (buffered >= m_target)
+            return true;
+        return nowNs > oldestDequeueNs && nowNs - oldestDequeueNs >= m_budgetNs;
+    }
+
+    // Called after each drain that produced events
+    void update(size_t drainedEvents) {
+        if (drainedEvents > m_target)
+            m_target = std::min(m_target * 2, m_maxEvents);
+        else if (drainedEvents * 4 < m_target)
+            m_target = std::max(m_target / 2, m_minEvents);
+    }
+
+private:
+    size_t m_maxEvents;
+    size_t m_minEvents;
+    uint64_t m_budgetNs;
+    size_t m_target;
+};
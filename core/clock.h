@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// Monotonic nanosecond clock shared by every stage of the pipeline, so
+// capture, dequeue and injection timestamps are directly comparable.
+// QueryPerformanceCounter on Windows, CLOCK_MONOTONIC elsewhere (which is
+// also the clock evdev is switched to for kernel event timestamps).
+
+#ifdef _WIN32
+inline int64_t QueryClockFrequency() {
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    return frequency.QuadPart;
+}
+
+inline const int64_t g_clockFrequency = QueryClockFrequency();
+#endif
+
+inline uint64_t MonotonicNanos() {
+#ifdef _WIN32
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    // Split to avoid overflowing counter * 1e9
+    int64_t seconds = counter.QuadPart / g_clockFrequency;
+    int64_t remainder = counter.QuadPart % g_clockFrequency;
+    return static_cast<uint64_t>(seconds) * 1000000000ull +
+           static_cast<uint64_t>(remainder * 1000000000ll / g_clockFrequency);
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+#endif
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "hid_reports.h"
+
+// Report descriptor for the composite loopback device. Each collection uses
+// the HIDReportType value as its report ID, and every report on the wire
+// starts with that ID byte.
+//
+//   Keyboard (boot): modifiers, reserved, 6 usages               9 bytes
+//   Keyboard (NKRO): 256-usage bitmap, modifiers at 0xE0-0xE7   33 bytes
+//   Mouse: 5 buttons, int16 X/Y, int8 wheel and AC pan            8 bytes
+//   Gamepad: int16 X/Y/Rx/Ry, uint16 Z/Rz, hat nibble, 32 buttons 18 bytes
+
+constexpr uint8_t HID_REPORT_DESCRIPTOR[] = {
+#ifdef HID_NKRO_REPORTS
+    0x05, 0x01,       // Usage Page (Generic Desktop)
+    0x09, 0x06,       // Usage (Keyboard)
+    0xA1, 0x01,       // Collection (Application)
+    0x85, 0x01,       //   Report ID (KEYBOARD)
+    0x05, 0x07,       //   Usage Page (Keyboard)
+    0x19, 0x00,       //   Usage Minimum (0)
+    0x2A, 0xFF, 0x00, //   Usage Maximum (255)
+    0x15, 0x00,       //   Logical Minimum (0)
+    0x25, 0x01,       //   Logical Maximum (1)
+    0x75, 0x01,       //   Report Size (1)
+    0x96, 0x00, 0x01, //   Report Count (256)
+    0x81, 0x02,       //   Input (Data, Variable, Absolute)
+    0xC0,             // End Collection
+#else
+    0x05, 0x01,       // Usage Page (Generic Desktop)
+    0x09, 0x06,       // Usage (Keyboard)
+    0xA1, 0x01,       // Collection (Application)
+    0x85, 0x01,       //   Report ID (KEYBOARD)
+    0x05, 0x07,       //   Usage Page (Keyboard)
+    0x19, 0xE0,       //   Usage Minimum (Left Control)
+    0x29, 0xE7,       //   Usage Maximum (Right GUI)
+    0x15, 0x00,       //   Logical Minimum (0)
+    0x25, 0x01,       //   Logical Maximum (1)
+    0x75, 0x01,       //   Report Size (1)
+    0x95, 0x08,       //   Report Count (8)
+    0x81, 0x02,       //   Input (Data, Variable, Absolute)
+    0x75, 0x08,       //   Report Size (8)
+    0x95, 0x01,       //   Report Count (1)
+    0x81, 0x01,       //   Input (Constant), reserved byte
+    0x19, 0x00,       //   Usage Minimum (0)
+    0x2A, 0xFF, 0x00, //   Usage Maximum (255)
+    0x26, 0xFF, 0x00, //   Logical Maximum (255)
+    0x95, 0x06,       //   Report Count (6)
+    0x81, 0x00,       //   Input (Data, Array)
+    0xC0,             // End Collection
+#endif
+
+    0x05, 0x01,       // Usage Page (Generic Desktop)
+    0x09, 0x02,       // Usage (Mouse)
+    0xA1, 0x01,       // Collection (Application)
+    0x85, 0x02,       //   Report ID (MOUSE)
+    0x09, 0x01,       //   Usage (Pointer)
+    0xA1, 0x00,       //   Collection (Physical)
+    0x05, 0x09,       //     Usage Page (Button)
+    0x19, 0x01,       //     Usage Minimum (1)
+    0x29, 0x05,       //     Usage Maximum (5)
+    0x15, 0x00,       //     Logical Minimum (0)
+    0x25, 0x01,       //     Logical Maximum (1)
+    0x75, 0x01,       //     Report Size (1)
+    0x95, 0x05,       //     Report Count (5)
+    0x81, 0x02,       //     Input (Data, Variable, Absolute)
+    0x75, 0x03,       //     Report Size (3)
+    0x95, 0x01,       //     Report Count (1)
+    0x81, 0x01,       //     Input (Constant), padding
+    0x05, 0x01,       //     Usage Page (Generic Desktop)
+    0x09, 0x30,       //     Usage (X)
+    0x09, 0x31,       //     Usage (Y)
+    0x16, 0x01, 0x80, //     Logical Minimum (-32767)
+    0x26, 0xFF, 0x7F, //     Logical Maximum (32767)
+    0x75, 0x10,       //     Report Size (16)
+    0x95, 0x02,       //     Report Count (2)
+    0x81, 0x06,       //     Input (Data, Variable, Relative)
+    0x09, 0x38,       //     Usage (Wheel)
+    0x15, 0x81,       //     Logical Minimum (-127)
+    0x25, 0x7F,       //     Logical Maximum (127)
+    0x75, 0x08,       //     Report Size (8)
+    0x95, 0x01,       //     Report Count (1)
+    0x81, 0x06,       //     Input (Data, Variable, Relative)
+    0x05, 0x0C,       //     Usage Page (Consumer)
+    0x0A, 0x38, 0x02, //     Usage (AC Pan)
+    0x81, 0x06,       //     Input (Data, Variable, Relative)
+    0xC0,             //   End Collection
+    0xC0,             // End Collection
+
+    0x05, 0x01,       // Usage Page (Generic Desktop)
+    0x09, 0x05,       // Usage (Game Pad)
+    0xA1, 0x01,       // Collection (Application)
+    0x85, 0x03,       //   Report ID (GAMEPAD)
+    0x09, 0x30,       //   Usage (X)
+    0x09, 0x31,       //   Usage (Y)
+    0x09, 0x33,       //   Usage (Rx)
+    0x09, 0x34,       //   Usage (Ry)
+    0x16, 0x00, 0x80, //   Logical Minimum (-32768)
+    0x26, 0xFF, 0x7F, //   Logical Maximum (32767)
+    0x75, 0x10,       //   Report Size (16)
+    0x95, 0x04,       //   Report Count (4)
+    0x81, 0x02,       //   Input (Data, Variable, Absolute)
+    0x09, 0x32,       //   Usage (Z), left trigger
+    0x09, 0x35,       //   Usage (Rz), right trigger
+    0x15, 0x00,       //   Logical Minimum (0)
+    0x27, 0xFF, 0xFF, 0x00, 0x00, //   Logical Maximum (65535)
+    0x95, 0x02,       //   Report Count (2)
+    0x81, 0x02,       //   Input (Data, Variable, Absolute)
+    0x09, 0x39,       //   Usage (Hat Switch)
+    0x25, 0x07,       //   Logical Maximum (7)
+    0x35, 0x00,       //   Physical Minimum (0)
+    0x46, 0x3B, 0x01, //   Physical Maximum (315)
+    0x65, 0x14,       //   Unit (Degrees)
+    0x75, 0x04,       //   Report Size (4)
+    0x95, 0x01,       //   Report Count (1)
+    0x81, 0x42,       //   Input (Data, Variable, Absolute, Null State)
+    0x65, 0x00,       //   Unit (None)
+    0x45, 0x00,       //   Physical Maximum (0)
+    0x81, 0x01,       //   Input (Constant), padding nibble
+    0x05, 0x09,       //   Usage Page (Button)
+    0x19, 0x01,       //   Usage Minimum (1)
+    0x29, 0x20,       //   Usage Maximum (32)
+    0x25, 0x01,       //   Logical Maximum (1)
+    0x75, 0x01,       //   Report Size (1)
+    0x95, 0x20,       //   Report Count (32)
+    0x81, 0x02,       //   Input (Data, Variable, Absolute)
+    0xC0,             // End Collection
+};
+
+// Wire sizes including the report ID byte
+#ifdef HID_NKRO_REPORTS
+constexpr size_t HID_KEYBOARD_REPORT_SIZE = 33;
+#else
+constexpr size_t HID_KEYBOARD_REPORT_SIZE = 9;
+#endif
+constexpr size_t HID_MOUSE_REPORT_SIZE = 8;
+constexpr size_t HID_GAMEPAD_REPORT_SIZE = 18;
+constexpr size_t HID_MAX_REPORT_SIZE = 33;
+
+// Relative fields as declared above
+constexpr int32_t HID_MOTION_LIMIT = 32767;
+constexpr int32_t HID_WHEEL_LIMIT = 127;
@@ -0,0 +1,43 @@
+#include "hid_file_sink.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+HidFileSink::HidFileSink(std::string path) : m_path(std::move(path)) {}
+
+HidFileSink::~HidFileSink() {
+    close();
+}
+
+bool HidFileSink::open() {
+    m_file = std::fopen(m_path.c_str(), "wb");
+    if (!m_file) {
+        std::cerr << "Failed to open " << m_path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Unbuffered, so each batch reaches the file in a single write
+    std::setvbuf(m_file, nullptr, _IONBF, 0);
+    resetState();
+    return true;
+}
+
+void HidFileSink::close() {
+    if (m_file) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+bool HidFileSink::writeReports(HidWireReport* reports, size_t count) {
+    if (!m_file)
+        return false;
+
+    size_t size = 0;
+    for (size_t i = 0; i < count; i++) {
+        memcpy(m_buffer + size, reports[i].bytes, reports[i].size);
+        size += reports[i].size;
+    }
+    return std::fwrite(m_buffer, 1, size, m_file) == size;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+
+#include "hid_report_sink.h"
+
+// Stand-in for the uhid device on hosts without /dev/uhid: appends the same
+// wire reports to a file (or FIFO), one write per batch. Report sizes are
+// fixed per report ID, so the stream is parsed by reading the ID byte.
+class HidFileSink : public HidReportSink {
+public:
+    explicit HidFileSink(std::string path);
+    ~HidFileSink() override;
+
+    const char* name() const override { return "hid-file"; }
+    bool open() override;
+    void close() override;
+
+protected:
+    bool writeReports(HidWireReport* reports, size_t count) override;
+
+private:
+    std::string m_path;
+    std::FILE* m_file = nullptr;
+    uint8_t m_buffer[MAX_BATCH * HID_MAX_REPORT_SIZE];
+};
@@ -0,0 +1,138 @@
+#include "hid_report_sink.h"
+
+#include "hid_wire.h"
+#include "motion_split.h"
+
+void HidReportSink::resetState() {
+    m_mouseButtons = 0;
+    m_keys = KeyBitmap{};
+    m_gamepad = GamepadReport{};
+    m_wheelRemainder = 0;
+    m_hwheelRemainder = 0;
+    m_reportCount = 0;
+    m_resyncPending = false;
+}
+
+HidWireReport& HidReportSink::nextReport() {
+    // Long motion splits can outgrow one batch; hand over what we have
+    if (m_reportCount == MAX_BATCH)
+        flushReports();
+    return m_reports[m_reportCount++];
+}
+
+bool HidReportSink::flushReports() {
+    if (m_reportCount > 0 && !m_failed) {
+        uint64_t writeStart = MonotonicNanos();
+        bool written = writeReports(m_reports, m_reportCount);
+        recordWrite(m_currentEvent - m_eventsRecorded, writeStart);
+        m_eventsRecorded = m_currentEvent;
+        if (written) {
+            m_eventsWritten = m_currentEvent;
+        } else {
+            m_failed = true;
+            m_resyncPending = true;
+        }
+    }
+    m_reportCount = 0;
+    return !m_failed;
+}
+
+void HidReportSink::appendMouse(int32_t x, int32_t y, int32_t wheel, int32_t hwheel) {
+    MouseReport mouse;
+    mouse.buttons = m_mouseButtons;
+    mouse.x = x;
+    mouse.y = y;
+    mouse.wheel = wheel * WHEEL_UNITS_PER_NOTCH;
+    mouse.hwheel = hwheel * WHEEL_UNITS_PER_NOTCH;
+
+    HidWireReport& report = nextReport();
+    report.size = HID_MOUSE_REPORT_SIZE;
+    EncodeMouseReport(mouse, report.bytes);
+}
+
+void HidReportSink::appendKeyboard() {
+    KeyboardReport keyboard;
+    keyboard.setHeldKeys(m_keys);
+
+    HidWireReport& report = nextReport();
+    report.size = HID_KEYBOARD_REPORT_SIZE;
+    EncodeKeyboardReport(keyboard, report.bytes);
+}
+
+void HidReportSink::appendGamepad() {
+    HidWireReport& report = nextReport();
+    report.size = HID_GAMEPAD_REPORT_SIZE;
+    EncodeGamepadReport(m_gamepad, report.bytes);
+}
+
+size_t HidReportSink::send(const InputEvent* events, size_t count) {
+    m_reportCount = 0;
+    m_eventsWritten = 0;
+    m_eventsRecorded = 0;
+    m_failed = false;
+
+    // A failed write lost reports; restate everything held so the device
+    // catches up with the events folded in since
+    if (m_resyncPending) {
+        m_resyncPending = false;
+        appendMouse(0, 0, 0, 0);
+        appendKeyboard();
+        appendGamepad();
+    }
+
+    // After a failed write the rest of the batch is still folded into the
+    // device state, but not written
+    for (size_t i = 0; i < count; i++) {
+        const InputEvent& event = events[i];
+        m_currentEvent = i;
+
+        switch (event.type) {
+            case InputEventType::MOUSE_MOVE:
+                SplitMotion(event.dx, event.dy, HID_MOTION_LIMIT,
+                            [&](int32_t x, int32_t y) { appendMouse(x, y, 0, 0); });
+                break;
+            case InputEventType::MOUSE_BUTTON:
+                m_mouseButtons = event.value ? (m_mouseButtons | event.code) : (m_mouseButtons & ~event.code);
+                appendMouse(0, 0, 0, 0);
+                break;
+            case InputEventType::MOUSE_WHEEL:
+            case InputEventType::MOUSE_HWHEEL: {
+                // The descriptor declares whole detents; carry the fraction
+                bool vertical = event.type == InputEventType::MOUSE_WHEEL;
+                int32_t& remainder = vertical ? m_wheelRemainder : m_hwheelRemainder;
+                int64_t total = int64_t(remainder) + event.value;
+                int32_t notches = static_cast<int32_t>(total / WHEEL_UNITS_PER_NOTCH);
+                remainder = static_cast<int32_t>(total - int64_t(notches) * WHEEL_UNITS_PER_NOTCH);
+                SplitMotion(vertical ? notches : 0, vertical ? 0 : notches, HID_WHEEL_LIMIT,
+                            [&](int32_t wheel, int32_t hwheel) { appendMouse(0, 0, wheel, hwheel); });
+                break;
+            }
+            case InputEventType::KEY:
+                m_keys.assign(event.code, event.value != 0);
+                appendKeyboard();
+                break;
+            case InputEventType::GAMEPAD_AXIS:
+            case InputEventType::GAMEPAD_BUTTON: {
+                if (event.type == InputEventType::GAMEPAD_BUTTON) {
+                    uint32_t bit = 1u << event.code;
+                    m_gamepad.buttons = event.value ? (m_gamepad.buttons | bit) : (m_gamepad.buttons & ~bit);
+                } else if (event.code < GAMEPAD_AXIS_LT) {
+                    m_gamepad.sticks[event.code] = static_cast<int16_t>(event.value);
+                } else if (event.code < GAMEPAD_AXIS_HAT) {
+                    m_gamepad.triggers[event.code - GAMEPAD_AXIS_LT] = static_cast<uint16_t>(event.value);
+                } else {
+                    m_gamepad.hat = static_cast<uint8_t>(event.value);
+                }
+
+                // One wire report per pad report, once all its changes are in
+                if (event.endOfReport || i + 1 == count)
+                    appendGamepad();
+                break;
+            }
+        }
+    }
+
+    m_currentEvent = count;
+    flushReports();
+    return m_failed ? m_eventsWritten : count;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "hid_descriptor.h"
+#include "input_backend.h"
+
+// Bytes kept free in front of each report for a transport header (uhid's
+// event type and payload size), so the header and report can be written
+// from one buffer without copying the report
+constexpr size_t HID_TRANSPORT_HEADER_ROOM = 6;
+
+// One report as it goes on the wire, report ID first
+struct HidWireReport {
+    uint8_t header[HID_TRANSPORT_HEADER_ROOM];
+    uint8_t bytes[HID_MAX_REPORT_SIZE];
+    uint8_t size;
+};
+
+static_assert(offsetof(HidWireReport, bytes) == HID_TRANSPORT_HEADER_ROOM,
+              "the transport header must sit directly before the report");
+
+// Base for sinks that present a real HID device. Events are folded back into
+// device state and emitted as reports for HID_REPORT_DESCRIPTOR: one mouse
+// report per motion step, button or wheel change, one keyboard report per
+// key transition, and one gamepad report per source report. Subclasses only
+// move finished reports to their device, once per batch.
+class HidReportSink : public InputSink {
+public:
+    static constexpr size_t MAX_BATCH = MAX_INJECT_BATCH;
+
+    size_t send(const InputEvent* events, size_t count) override;
+
+protected:
+    // Writes a batch of finished reports, filling each header room if the
+    // transport needs one. On false the rest of the current send() is folded
+    // into the device state but not written, and the next send() restates it
+    virtual bool writeReports(HidWireReport* reports, size_t count) = 0;
+
+    // Forget held buttons, keys and axes, e.g. when the device is recreated
+    void resetState();
+
+private:
+    HidWireReport& nextReport();
+    bool flushReports();
+    void appendMouse(int32_t x, int32_t y, int32_t wheel, int32_t hwheel);
+    void appendKeyboard();
+    void appendGamepad();
+
+    uint8_t m_mouseButtons = 0;
+    KeyBitmap m_keys;
+    GamepadReport m_gamepad;
+
+    // Sub-detent wheel travel not yet reported
+    int32_t m_wheelRemainder = 0;
+    int32_t m_hwheelRemainder = 0;
+
+    HidWireReport m_reports[MAX_BATCH];
+    size_t m_reportCount = 0;
+
+    // Progress through the current send(), for short-write accounting
+    size_t m_currentEvent = 0;
+    size_t m_eventsWritten = 0;
+    size_t m_eventsRecorded = 0;
+    bool m_failed = false;
+
+    // Restate the full device state before the next batch
+    bool m_resyncPending = false;
+};
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "key_bitmap.h"
+
+// Constants
+constexpr uint16_t LOOPBACK_VENDOR_ID = 0x0C45;
+constexpr uint16_t LOOPBACK_PRODUCT_ID = 0x7403;
+// Our virtual devices also report BUS_VIRTUAL and this version, so a real
+// device that happens to share the IDs is still captured
+constexpr uint16_t LOOPBACK_VERSION = 0x4C42;  // "LB"
+constexpr size_t MAX_QUEUE_SIZE = 32;  // Limit queue size to prevent memory growth
+constexpr int POLLING_INTERVAL_MS = 1;  // Faster polling interval
+
+// Wheel deltas are carried at full resolution: one detent is 120 units,
+// matching WHEEL_DELTA and the kernel's REL_WHEEL_HI_RES scale
+constexpr int32_t WHEEL_UNITS_PER_NOTCH = 120;
+
+// Optimized fixed-size HID Reports
+enum class HIDReportType : uint8_t {
+    KEYBOARD = 0x01,
+    MOUSE = 0x02,
+    GAMEPAD = 0x03
+};
+
+// Mouse button bits
+constexpr uint8_t MOUSE_BUTTON_LEFT = 0x01;
+constexpr uint8_t MOUSE_BUTTON_RIGHT = 0x02;
+constexpr uint8_t MOUSE_BUTTON_MIDDLE = 0x04;
+constexpr uint8_t MOUSE_BUTTON_X1 = 0x08;      // Back
+constexpr uint8_t MOUSE_BUTTON_X2 = 0x10;      // Forward
+constexpr size_t MOUSE_BUTTON_COUNT = 5;
+constexpr uint8_t MOUSE_BUTTON_MASK = (1u << MOUSE_BUTTON_COUNT) - 1;
+
+// Keyboard modifier bits (HID boot protocol layout)
+constexpr uint8_t MODIFIER_LCTRL = 0x01;
+constexpr uint8_t MODIFIER_LSHIFT = 0x02;
+constexpr uint8_t MODIFIER_LALT = 0x04;
+constexpr uint8_t MODIFIER_LGUI = 0x08;
+constexpr uint8_t MODIFIER_RCTRL = 0x10;
+constexpr uint8_t MODIFIER_RSHIFT = 0x20;
+constexpr uint8_t MODIFIER_RALT = 0x40;
+constexpr uint8_t MODIFIER_RGUI = 0x80;
+
+// Every report names the device it was captured from. Sources that can tell
+// devices apart number them from 1 in the order they were opened; 0 means
+// the source cannot (the Windows hooks). The ID sits in what was padding.
+constexpr uint16_t DEVICE_UNKNOWN = 0;
+
+// Fixed-size mouse report to avoid dynamic allocation. Deltas are 32-bit
+// inside the pipeline; sinks with narrower fields split them on output
+// (see motion_split.h). Fields are ordered widest first so queue entries
+// carry no interior padding; hid_wire.h defines the on-the-wire layout.
+struct MouseReport {
+    uint64_t timestamp;   // Capture time, MonotonicNanos()
+    int32_t x;            // X movement in device counts
+    int32_t y;            // Y movement in device counts
+    int32_t wheel;        // Vertical wheel, WHEEL_UNITS_PER_NOTCH per detent
+    int32_t hwheel;       // Horizontal wheel, positive is right
+    uint32_t sequence;    // Capture order across all devices
+    uint8_t buttons;      // Full held-button state, MOUSE_BUTTON_* bits
+    uint16_t device;      // Capturing device
+
+    constexpr MouseReport()
+        : timestamp(0), x(0), y(0), wheel(0), hwheel(0), sequence(0), buttons(0), device(0) {}
+};
+
+static_assert(sizeof(MouseReport) == 32, "two mouse reports per cache line");
+
+// Keyboard reports. Keys are HID keyboard usage IDs (page 0x07) so every
+// backend speaks the same code space; see keycodes.h for the platform
+// mappings. Both formats expose the held keys as a KeyBitmap, which is all
+// the sources and the translator touch.
+
+// Boot protocol layout, six keys at most (6KRO)
+struct BootKeyboardReport {
+    static constexpr size_t MAX_KEYS = 6;
+    // Every key and modifier released and pressed in one report
+    static constexpr size_t MAX_TRANSITIONS = (MAX_KEYS + 8) * 2;
+
+    uint8_t modifiers;    // Ctrl, Alt, Shift, etc.
+    uint8_t reserved;     // Reserved byte
+    uint8_t keys[6];      // Up to 6 keys pressed simultaneously
+    uint64_t timestamp;   // Capture time, MonotonicNanos()
+    uint32_t sequence;    // Capture order across all devices
+    uint16_t device;      // Capturing device
+
+    constexpr BootKeyboardReport()
+        : modifiers(0), reserved(0), keys{}, timestamp(0), sequence(0), device(0) {}
+
+    // Usages 1-3 are the rollover/error codes and never name a real key
+    KeyBitmap heldKeys() const {
+        KeyBitmap held;
+        held.setModifiers(modifiers);
+        for (size_t i = 0; i < MAX_KEYS; i++) {
+            if (keys[i] > 3)
+                held.set(keys[i]);
+        }
+        return held;
+    }
+
+    // Keeps the modifiers and the six lowest held usages
+    void setHeldKeys(const KeyBitmap& held) {
+        modifiers = held.modifiers();
+        size_t keyIndex = 0;
+        held.withoutModifiers().forEach([&](uint8_t usage) {
+            keys[keyIndex++] = usage;
+            return keyIndex < MAX_KEYS;
+        });
+    }
+};
+
+// Full usage bitmap, any number of keys (NKRO). Modifiers are the bitmap's
+// 0xE0-0xE7 bits.
+struct NkroKeyboardReport {
+    static constexpr size_t MAX_KEYS = 256;
+    static constexpr size_t MAX_TRANSITIONS = 256;
+
+    KeyBitmap keys;       // Held usages, modifiers included
+    uint64_t timestamp;   // Capture time, MonotonicNanos()
+    uint32_t sequence;    // Capture order across all devices
+    uint16_t device;      // Capturing device
+
+    constexpr NkroKeyboardReport() : timestamp(0), sequence(0), device(0) {}
+
+    KeyBitmap heldKeys() const { return keys; }
+    void setHeldKeys(const KeyBitmap& held) { keys = held; }
+};
+
+// Report format carried through the pipeline, fixed at build time so the
+// queue, drain and translator never branch on it
+#ifdef HID_NKRO_REPORTS
+using KeyboardReport = NkroKeyboardReport;
+constexpr const char* KEYBOARD_REPORT_FORMAT = "NKRO";
+#else
+using KeyboardReport = BootKeyboardReport;
+constexpr const char* KEYBOARD_REPORT_FORMAT = "6KRO";
+#endif
+
+// Gamepad axis codes, carried in InputEvent::code for GAMEPAD_AXIS events
+constexpr uint8_t GAMEPAD_AXIS_LX = 0;
+constexpr uint8_t GAMEPAD_AXIS_LY = 1;
+constexpr uint8_t GAMEPAD_AXIS_RX = 2;
+constexpr uint8_t GAMEPAD_AXIS_RY = 3;
+constexpr uint8_t GAMEPAD_AXIS_LT = 4;
+constexpr uint8_t GAMEPAD_AXIS_RT = 5;
+constexpr uint8_t GAMEPAD_AXIS_HAT = 6;
+constexpr size_t GAMEPAD_AXIS_COUNT = 7;
+
+constexpr size_t GAMEPAD_BUTTON_COUNT = 32;
+constexpr uint8_t GAMEPAD_HAT_CENTERED = 8;
+
+// Fixed-size gamepad report. Buttons 0-14 follow the standard gamepad
+// order (south, east, C, north, west, Z, TL, TR, TL2, TR2, select, start,
+// mode, thumb L, thumb R); 16-31 are extra joystick buttons.
+struct GamepadReport {
+    uint64_t timestamp;   // Capture time, MonotonicNanos()
+    int16_t sticks[4];    // LX, LY, RX, RY over the full range, +Y is down
+    uint16_t triggers[2]; // LT, RT, 0 released to 65535 fully pressed
+    uint32_t buttons;     // Held buttons, one bit each
+    uint32_t sequence;    // Capture order across all devices
+    uint8_t hat;          // 0-7 clockwise from up, or GAMEPAD_HAT_CENTERED
+    uint16_t device;      // Capturing device
+
+    constexpr GamepadReport()
+        : timestamp(0), sticks{}, triggers{}, buttons(0), sequence(0), hat(GAMEPAD_HAT_CENTERED),
+          device(0) {}
+
+    // Value of a GAMEPAD_AXIS_* code
+    int32_t axis(uint8_t code) const {
+        if (code < GAMEPAD_AXIS_LT) return sticks[code];
+        if (code < GAMEPAD_AXIS_HAT) return triggers[code - GAMEPAD_AXIS_LT];
+        return hat;
+    }
+};
+
+static_assert(sizeof(GamepadReport) == 32, "two gamepad reports per cache line");
+
+// Hat position from D-pad axes, each -1/0/1 with +Y down
+constexpr uint8_t GamepadHatFromAxes(int x, int y) {
+    constexpr uint8_t HAT_BY_AXES[3][3] = {
+        {7, 0, 1},
+        {6, GAMEPAD_HAT_CENTERED, 2},
+        {5, 4, 3},
+    };
+    return HAT_BY_AXES[y + 1][x + 1];
+}
+
+constexpr void GamepadHatToAxes(uint8_t hat, int& x, int& y) {
+    constexpr int8_t HAT_X[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+    constexpr int8_t HAT_Y[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+    x = hat < 8 ? HAT_X[hat] : 0;
+    y = hat < 8 ? HAT_Y[hat] : 0;
+}
+
+// Wrap-safe ordering of capture sequence numbers
+inline bool SequenceBefore(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) < 0;
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "hid_descriptor.h"
+#include "hid_reports.h"
+
+// Byte layouts of the reports declared by HID_REPORT_DESCRIPTOR, with
+// encoders and decoders between them and the in-memory report types. All
+// multi-byte fields are little-endian; the helpers below are written so
+// compilers fold them into single unaligned loads and stores on
+// little-endian targets. Everything is constexpr, so layouts are checked
+// at compile time at the bottom of this file.
+//
+//   Mouse     [0] ID  [1] buttons  [2-3] x  [4-5] y  [6] wheel  [7] pan
+//   Keyboard  [0] ID  [1] modifiers  [2] reserved  [3-8] usages      (boot)
+//             [0] ID  [1-32] usage bitmap, usage n at bit n % 8 of n / 8 (NKRO)
+//   Gamepad   [0] ID  [1-8] LX LY RX RY  [9-12] LT RT  [13] hat  [14-17] buttons
+
+namespace hid_wire {
+
+constexpr size_t MOUSE_BUTTONS = 1;
+constexpr size_t MOUSE_X = 2;
+constexpr size_t MOUSE_Y = 4;
+constexpr size_t MOUSE_WHEEL = 6;
+constexpr size_t MOUSE_PAN = 7;
+
+constexpr size_t BOOT_MODIFIERS = 1;
+constexpr size_t BOOT_RESERVED = 2;
+constexpr size_t BOOT_KEYS = 3;
+constexpr size_t BOOT_SIZE = 9;
+
+constexpr size_t NKRO_BITMAP = 1;
+constexpr size_t NKRO_SIZE = 33;
+
+constexpr size_t GAMEPAD_STICKS = 1;
+constexpr size_t GAMEPAD_TRIGGERS = 9;
+constexpr size_t GAMEPAD_HAT = 13;
+constexpr size_t GAMEPAD_BUTTONS = 14;
+
+constexpr void Store16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+constexpr void Store32(uint8_t* out, uint32_t value) {
+    Store16(out, static_cast<uint16_t>(value));
+    Store16(out + 2, static_cast<uint16_t>(value >> 16));
+}
+
+constexpr uint16_t Load16(const uint8_t* in) {
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+constexpr uint32_t Load32(const uint8_t* in) {
+    return Load16(in) | (uint32_t(Load16(in + 2)) << 16);
+}
+
+}  // namespace hid_wire
+
+// Motion must already fit the wire (|x|, |y| <= HID_MOTION_LIMIT) and the
+// wheels must be whole detents within HID_WHEEL_LIMIT; split larger
+// reports with SplitMotion first.
+constexpr void EncodeMouseReport(const MouseReport& report, uint8_t* out) {
+    out[0] = static_cast<uint8_t>(HIDReportType::MOUSE);
+    out[hid_wire::MOUSE_BUTTONS] = report.buttons;
+    hid_wire::Store16(out + hid_wire::MOUSE_X, static_cast<uint16_t>(report.x));
+    hid_wire::Store16(out + hid_wire::MOUSE_Y, static_cast<uint16_t>(report.y));
+    out[hid_wire::MOUSE_WHEEL] = static_cast<uint8_t>(report.wheel / WHEEL_UNITS_PER_NOTCH);
+    out[hid_wire::MOUSE_PAN] = static_cast<uint8_t>(report.hwheel / WHEEL_UNITS_PER_NOTCH);
+}
+
+constexpr MouseReport DecodeMouseReport(const uint8_t* in) {
+    MouseReport report;
+    report.buttons = in[hid_wire::MOUSE_BUTTONS];
+    report.x = static_cast<int16_t>(hid_wire::Load16(in + hid_wire::MOUSE_X));
+    report.y = static_cast<int16_t>(hid_wire::Load16(in + hid_wire::MOUSE_Y));
+    report.wheel = static_cast<int8_t>(in[hid_wire::MOUSE_WHEEL]) * WHEEL_UNITS_PER_NOTCH;
+    report.hwheel = static_cast<int8_t>(in[hid_wire::MOUSE_PAN]) * WHEEL_UNITS_PER_NOTCH;
+    return report;
+}
+
+constexpr void EncodeKeyboardReport(const BootKeyboardReport& report, uint8_t* out) {
+    out[0] = static_cast<uint8_t>(HIDReportType::KEYBOARD);
+    out[hid_wire::BOOT_MODIFIERS] = report.modifiers;
+    out[hid_wire::BOOT_RESERVED] = 0;
+    for (size_t i = 0; i < BootKeyboardReport::MAX_KEYS; i++)
+        out[hid_wire::BOOT_KEYS + i] = report.keys[i];
+}
+
+constexpr BootKeyboardReport DecodeBootKeyboardReport(const uint8_t* in) {
+    BootKeyboardReport report;
+    report.modifiers = in[hid_wire::BOOT_MODIFIERS];
+    for (size_t i = 0; i < BootKeyboardReport::MAX_KEYS; i++)
+        report.keys[i] = in[hid_wire::BOOT_KEYS + i];
+    return report;
+}
+
+constexpr void EncodeKeyboardReport(const NkroKeyboardReport& report, uint8_t* out) {
+    out[0] = static_cast<uint8_t>(HIDReportType::KEYBOARD);
+    for (size_t i = 0; i < 4; i++) {
+        hid_wire::Store32(out + hid_wire::NKRO_BITMAP + i * 8, static_cast<uint32_t>(report.keys.words[i]));
+        hid_wire::Store32(out + hid_wire::NKRO_BITMAP + i * 8 + 4, static_cast<uint32_t>(report.keys.words[i] >> 32));
+    }
+}
+
+constexpr NkroKeyboardReport DecodeNkroKeyboardReport(const uint8_t* in) {
+    NkroKeyboardReport report;
+    for (size_t i = 0; i < 4; i++) {
+        report.keys.words[i] = hid_wire::Load32(in + hid_wire::NKRO_BITMAP + i * 8) |
+                               (uint64_t(hid_wire::Load32(in + hid_wire::NKRO_BITMAP + i * 8 + 4)) << 32);
+    }
+    return report;
+}
+
+constexpr void EncodeGamepadReport(const GamepadReport& report, uint8_t* out) {
+    out[0] = static_cast<uint8_t>(HIDReportType::GAMEPAD);
+    for (size_t i = 0; i < 4; i++)
+        hid_wire::Store16(out + hid_wire::GAMEPAD_STICKS + i * 2, static_cast<uint16_t>(report.sticks[i]));
+    hid_wire::Store16(out + hid_wire::GAMEPAD_TRIGGERS, report.triggers[0]);
+    hid_wire::Store16(out + hid_wire::GAMEPAD_TRIGGERS + 2, report.triggers[1]);
+    out[hid_wire::GAMEPAD_HAT] = report.hat;  // Centered (8) is outside 0-7, the null state
+    hid_wire::Store32(out + hid_wire::GAMEPAD_BUTTONS, report.buttons);
+}
+
+constexpr GamepadReport DecodeGamepadReport(const uint8_t* in) {
+    GamepadReport report;
+    for (size_t i = 0; i < 4; i++)
+        report.sticks[i] = static_cast<int16_t>(hid_wire::Load16(in + hid_wire::GAMEPAD_STICKS + i * 2));
+    report.triggers[0] = hid_wire::Load16(in + hid_wire::GAMEPAD_TRIGGERS);
+    report.triggers[1] = hid_wire::Load16(in + hid_wire::GAMEPAD_TRIGGERS + 2);
+    report.hat = in[hid_wire::GAMEPAD_HAT] & 0x0F;
+    report.buttons = hid_wire::Load32(in + hid_wire::GAMEPAD_BUTTONS);
+    return report;
+}
+
+// Wire size of a report from its ID byte, 0 for unknown IDs
+constexpr size_t HidWireReportSize(uint8_t reportId) {
+    switch (static_cast<HIDReportType>(reportId)) {
+        case HIDReportType::KEYBOARD: return HID_KEYBOARD_REPORT_SIZE;
+        case HIDReportType::MOUSE:    return HID_MOUSE_REPORT_SIZE;
+        case HIDReportType::GAMEPAD:  return HID_GAMEPAD_REPORT_SIZE;
+    }
+    return 0;
+}
+
+// Layouts agree with the descriptor's sizes and survive a round trip
+static_assert(hid_wire::MOUSE_PAN + 1 == HID_MOUSE_REPORT_SIZE);
+static_assert(hid_wire::GAMEPAD_BUTTONS + 4 == HID_GAMEPAD_REPORT_SIZE);
+static_assert(hid_wire::NKRO_SIZE <= HID_MAX_REPORT_SIZE && hid_wire::BOOT_SIZE <= HID_MAX_REPORT_SIZE);
+
+static_assert([] {
+    MouseReport report;
+    report.buttons = MOUSE_BUTTON_LEFT | MOUSE_BUTTON_X2;
+    report.x = -HID_MOTION_LIMIT;
+    report.y = 1234;
+    report.wheel = -3 * WHEEL_UNITS_PER_NOTCH;
+    report.hwheel = HID_WHEEL_LIMIT * WHEEL_UNITS_PER_NOTCH;
+    uint8_t bytes[HID_MOUSE_REPORT_SIZE] = {};
+    EncodeMouseReport(report, bytes);
+    MouseReport decoded = DecodeMouseReport(bytes);
+    return bytes[0] == 0x02 && bytes[hid_wire::MOUSE_X] == 0x01 && bytes[hid_wire::MOUSE_X + 1] == 0x80 &&
+           decoded.buttons == report.buttons && decoded.x == report.x && decoded.y == report.y &&
+           decoded.wheel == report.wheel && decoded.hwheel == report.hwheel;
+}());
+
+static_assert([] {
+    BootKeyboardReport report;
+    report.modifiers = MODIFIER_LSHIFT | MODIFIER_RALT;
+    report.keys[0] = 0x04;
+    report.keys[5] = 0x65;
+    uint8_t bytes[hid_wire::BOOT_SIZE] = {};
+    EncodeKeyboardReport(report, bytes);
+    BootKeyboardReport decoded = DecodeBootKeyboardReport(bytes);
+    return bytes[0] == 0x01 && bytes[hid_wire::BOOT_KEYS] == 0x04 && decoded.modifiers == report.modifiers &&
+           decoded.keys[0] == report.keys[0] && decoded.keys[5] == report.keys[5];
+}());
+
+static_assert([] {
+    NkroKeyboardReport report;
+    report.keys.words[0] = 0x10;                  // A (usage 4)
+    report.keys.words[3] = uint64_t(0x02) << 32;  // Left shift (0xE1)
+    uint8_t bytes[hid_wire::NKRO_SIZE] = {};
+    EncodeKeyboardReport(report, bytes);
+    NkroKeyboardReport decoded = DecodeNkroKeyboardReport(bytes);
+    return bytes[1] == 0x10 && bytes[1 + 0xE1 / 8] == 0x02 &&
+           decoded.keys.words[0] == report.keys.words[0] && decoded.keys.words[3] == report.keys.words[3];
+}());
+
+static_assert([] {
+    GamepadReport report;
+    report.sticks[0] = -32768;
+    report.sticks[3] = 32767;
+    report.triggers[1] = 65535;
+    report.hat = 5;
+    report.buttons = 0x80000001u;
+    uint8_t bytes[HID_GAMEPAD_REPORT_SIZE] = {};
+    EncodeGamepadReport(report, bytes);
+    GamepadReport decoded = DecodeGamepadReport(bytes);
+    return bytes[0] == 0x03 && bytes[hid_wire::GAMEPAD_BUTTONS + 3] == 0x80 &&
+           decoded.sticks[0] == report.sticks[0] && decoded.sticks[3] == report.sticks[3] &&
+           decoded.triggers[1] == report.triggers[1] && decoded.hat == report.hat &&
+           decoded.buttons == report.buttons;
+}());
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "clock.h"
+#include "latency_histogram.h"
+
+struct InputPipeline;
+
+// Most events the processing thread hands to a sink at once; sinks size
+// their syscall buffers to match so a batch goes out in one write
+constexpr size_t MAX_INJECT_BATCH = 256;
+
+// Platform-neutral injection event produced by the translator
+enum class InputEventType : uint8_t {
+    MOUSE_MOVE,
+    MOUSE_BUTTON,
+    MOUSE_WHEEL,
+    MOUSE_HWHEEL,
+    KEY,
+    GAMEPAD_AXIS,
+    GAMEPAD_BUTTON
+};
+
+struct InputEvent {
+    InputEventType type;
+    uint8_t code;         // Mouse button bit, HID usage, gamepad axis or button index
+    bool endOfReport;     // Last event translated from its source report
+    int32_t value;        // 1 = down, 0 = up, wheel units (120 per detent) or axis value
+    int32_t dx;           // Relative X for MOUSE_MOVE
+    int32_t dy;           // Relative Y for MOUSE_MOVE
+    uint64_t captureNs;   // When the source report was captured
+    uint64_t dequeueNs;   // When the processing thread dequeued it
+};
+
+// Captures device input and pushes reports into the pipeline queues
+class InputSource {
+public:
+    virtual ~InputSource() = default;
+
+    virtual const char* name() const = 0;
+    virtual bool start(InputPipeline& pipeline) = 0;
+    virtual void stop() = 0;
+};
+
+// Injects translated events into the host
+class InputSink {
+public:
+    virtual ~InputSink() = default;
+
+    virtual const char* name() const = 0;
+    virtual bool open() = 0;
+    virtual void close() = 0;
+
+    // Injects a batch of events, returns how many were accepted
+    virtual size_t send(const InputEvent* events, size_t count) = 0;
+
+    // Where to record per-write telemetry, nullptr for none
+    virtual void setInjectionStats(InjectionStats* stats) { m_injectionStats = stats; }
+
+protected:
+    // Call after each injection syscall with how many InputEvents it consumed
+    // and when it began, so every sink's numbers mean the same thing
+    void recordWrite(size_t events, uint64_t startNs) {
+        if (m_injectionStats)
+            m_injectionStats->record(events, MonotonicNanos() - startNs);
+    }
+
+    InjectionStats* m_injectionStats = nullptr;
+};
@@ -0,0 +1,423 @@
+#include "input_pipeline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "clock.h"
+#include "keycodes.h"
+#include "ordered_drain.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+// Upper bound on a parked wait so shutdown and profiling stay responsive
+constexpr auto IDLE_WAIT_TIMEOUT = std::chrono::milliseconds(100);
+
+#ifndef _WIN32
+// Real-time priority of the processing thread: above normal threads, below
+// the threaded interrupt handlers (50) that deliver its input
+constexpr int PROCESSING_RT_PRIORITY = 10;
+
+// Nice value used instead when the thread busy-waits
+constexpr int PROCESSING_SPIN_NICE = -10;
+#endif
+
+// Raise the processing thread's priority. A thread that busy-waits never
+// gets a real-time policy, or it would starve the capture thread and
+// kernel workers on its core.
+void RaiseThreadPriority(WaitMode waitMode) {
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), waitMode == WaitMode::SPIN ? THREAD_PRIORITY_ABOVE_NORMAL
+                                                                     : THREAD_PRIORITY_TIME_CRITICAL);
+#else
+    // Both need CAP_SYS_NICE; stay at the default otherwise
+    if (waitMode == WaitMode::SPIN) {
+        // PRIO_PROCESS with 0 is the calling thread on Linux
+        setpriority(PRIO_PROCESS, 0, PROCESSING_SPIN_NICE);
+        return;
+    }
+    sched_param param{};
+    param.sched_priority = PROCESSING_RT_PRIORITY;
+    pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+#endif
+}
+
+// Prebuilt mouse events, copied whole and then given their payload
+constexpr InputEvent MakeEventTemplate(InputEventType type) {
+    InputEvent event{};
+    event.type = type;
+    return event;
+}
+
+constexpr InputEvent MOVE_EVENT = MakeEventTemplate(InputEventType::MOUSE_MOVE);
+constexpr InputEvent WHEEL_EVENT = MakeEventTemplate(InputEventType::MOUSE_WHEEL);
+constexpr InputEvent HWHEEL_EVENT = MakeEventTemplate(InputEventType::MOUSE_HWHEEL);
+
+// Button events by bit index and direction, generated at compile time
+struct ButtonEventTable {
+    InputEvent events[MOUSE_BUTTON_COUNT][2];
+};
+
+constexpr ButtonEventTable MakeButtonEventTable() {
+    ButtonEventTable table{};
+    for (unsigned bit = 0; bit < MOUSE_BUTTON_COUNT; bit++) {
+        for (int down = 0; down < 2; down++) {
+            InputEvent& event = table.events[bit][down];
+            event = MakeEventTemplate(InputEventType::MOUSE_BUTTON);
+            event.code = static_cast<uint8_t>(1u << bit);
+            event.value = down;
+        }
+    }
+    return table;
+}
+
+constexpr ButtonEventTable BUTTON_EVENTS = MakeButtonEventTable();
+
+bool IsGamepadEvent(const InputEvent& event) {
+    return event.type == InputEventType::GAMEPAD_AXIS || event.type == InputEventType::GAMEPAD_BUTTON;
+}
+
+bool IsWheelEvent(const InputEvent& event) {
+    return event.type == InputEventType::MOUSE_WHEEL || event.type == InputEventType::MOUSE_HWHEEL;
+}
+
+// Folds wheel events in [start, end) into a wheel event on the same axis
+// directly before them, so a burst of wheel reports injects once per batch.
+// The merged event keeps the earliest capture time and ends a report if
+// either did. Returns the new end.
+size_t CoalesceWheelEvents(InputEvent* events, size_t start, size_t end) {
+    size_t kept = start;
+    for (size_t i = start; i < end; i++) {
+        if (kept > 0 && IsWheelEvent(events[i]) && events[kept - 1].type == events[i].type) {
+            int64_t sum = int64_t(events[kept - 1].value) + events[i].value;
+            if (sum >= INT32_MIN && sum <= INT32_MAX) {
+                events[kept - 1].value = static_cast<int32_t>(sum);
+                events[kept - 1].endOfReport |= events[i].endOfReport;
+                continue;
+            }
+        }
+        events[kept++] = events[i];
+    }
+    return kept;
+}
+
+// Timestamps one report's events and marks its last, so sinks can keep a
+// report together without comparing capture times
+void StampEvents(InputEvent* events, size_t count, uint64_t captureNs, uint64_t dequeueNs) {
+    for (size_t i = 0; i < count; i++) {
+        events[i].captureNs = captureNs;
+        events[i].dequeueNs = dequeueNs;
+        events[i].endOfReport = i + 1 == count;
+    }
+}
+
+}  // namespace
+
+bool IsControlKey(uint8_t usage) {
+    return usage == HID_USAGE_F12 || usage == HID_USAGE_F11 || usage == HID_USAGE_ESCAPE;
+}
+
+bool HandleControlKey(InputPipeline& pipeline, uint8_t usage) {
+    // F12 toggles blocking
+    if (usage == HID_USAGE_F12) {
+        bool blocking = !pipeline.blockFeedback.load();
+        pipeline.blockFeedback = blocking;
+        pipeline.logger.postToggle(LogMessage::INPUT_BLOCKING, blocking);
+        return true;
+    }
+
+    // F11 toggles profiling
+    if (usage == HID_USAGE_F11) {
+        bool profiling = !pipeline.enableProfiling.load();
+        pipeline.enableProfiling = profiling;
+        pipeline.logger.postToggle(LogMessage::PROFILING, profiling);
+        return true;
+    }
+
+    // Escape exits the program
+    if (usage == HID_USAGE_ESCAPE) {
+        pipeline.running = false;
+        pipeline.wakeSignal.notify();
+        pipeline.logger.postMessage(LogMessage::EXITING);
+        return true;
+    }
+
+    return false;
+}
+
+size_t TranslateMouseReport(const MouseReport& report, MouseReport& lastState,
+                            uint64_t dequeueNs, InputEvent* out) {
+    size_t count = 0;
+
+    // Check if it's a movement event
+    if (report.x != 0 || report.y != 0) {
+        InputEvent& event = out[count++];
+        event = MOVE_EVENT;
+        event.dx = report.x;
+        event.dy = report.y;
+    }
+
+    // One event per changed button, lowest bit first
+    unsigned changedButtons = (report.buttons ^ lastState.buttons) & MOUSE_BUTTON_MASK;
+    while (changedButtons != 0) {
+        unsigned bit = CountTrailingZeros(changedButtons);
+        changedButtons &= changedButtons - 1;
+        out[count++] = BUTTON_EVENTS.events[bit][(report.buttons >> bit) & 1];
+    }
+
+    // Mouse wheel, both axes
+    if (report.wheel != 0) {
+        InputEvent& event = out[count++];
+        event = WHEEL_EVENT;
+        event.value = report.wheel;
+    }
+    if (report.hwheel != 0) {
+        InputEvent& event = out[count++];
+        event = HWHEEL_EVENT;
+        event.value = report.hwheel;
+    }
+
+    // Update last state
+    lastState = report;
+    StampEvents(out, count, report.timestamp, dequeueNs);
+    return count;
+}
+
+template <typename Report>
+size_t TranslateKeyboardReport(const Report& report, Report& lastState,
+                               uint64_t dequeueNs, InputEvent* out) {
+    KeyBitmap current = report.heldKeys();
+    KeyBitmap previous = lastState.heldKeys();
+    KeyBitmap released = previous - current;
+    KeyBitmap pressed = current - previous;
+    size_t count = 0;
+
+    auto emitKeys = [&](const KeyBitmap& keys, bool down) {
+        keys.forEach([&](uint8_t usage) {
+            InputEvent& event = out[count++];
+            event = InputEvent{};
+            event.type = InputEventType::KEY;
+            event.code = usage;
+            event.value = down ? 1 : 0;
+            return true;
+        });
+    };
+
+    // Releases before presses, and modifiers wrap the keys they apply to:
+    // key-ups, modifier-ups, modifier-downs, key-downs
+    KeyBitmap releasedKeys = released.withoutModifiers();
+    KeyBitmap pressedKeys = pressed.withoutModifiers();
+    emitKeys(releasedKeys, false);
+    emitKeys(released - releasedKeys, false);
+    emitKeys(pressed - pressedKeys, true);
+    emitKeys(pressedKeys, true);
+
+    lastState = report;
+    StampEvents(out, count, report.timestamp, dequeueNs);
+    return count;
+}
+
+template size_t TranslateKeyboardReport(const BootKeyboardReport&, BootKeyboardReport&,
+                                        uint64_t, InputEvent*);
+template size_t TranslateKeyboardReport(const NkroKeyboardReport&, NkroKeyboardReport&,
+                                        uint64_t, InputEvent*);
+
+size_t TranslateGamepadReport(const GamepadReport& report, GamepadReport& lastState,
+                              uint64_t dequeueNs, InputEvent* out) {
+    size_t count = 0;
+
+    for (uint8_t axis = 0; axis < GAMEPAD_AXIS_COUNT; axis++) {
+        int32_t value = report.axis(axis);
+        if (value == lastState.axis(axis))
+            continue;
+        InputEvent& event = out[count++];
+        event = InputEvent{};
+        event.type = InputEventType::GAMEPAD_AXIS;
+        event.code = axis;
+        event.value = value;
+    }
+
+    // Lowest button first
+    uint32_t changedButtons = report.buttons ^ lastState.buttons;
+    while (changedButtons != 0) {
+        unsigned bit = CountTrailingZeros(changedButtons);
+        changedButtons &= changedButtons - 1;
+        InputEvent& event = out[count++];
+        event = InputEvent{};
+        event.type = InputEventType::GAMEPAD_BUTTON;
+        event.code = static_cast<uint8_t>(bit);
+        event.value = (report.buttons >> bit) & 1;
+    }
+
+    lastState = report;
+    StampEvents(out, count, report.timestamp, dequeueNs);
+    return count;
+}
+
+void ProcessInputEvents(InputPipeline& pipeline, InputSink& sink) {
+    // Raise thread priority for minimal latency
+    RaiseThreadPriority(pipeline.waitMode);
+
+    // Performance monitoring
+    auto lastProfileTime = std::chrono::high_resolution_clock::now();
+    int frameCount = 0;
+    int eventCount = 0;
+
+    // Event buffer for the sink: a full batch plus the report that
+    // completes it
+    InputEvent eventBuffer[MAX_INJECT_BATCH + std::max({MAX_EVENTS_PER_MOUSE_REPORT,
+                                                        MAX_EVENTS_PER_KEYBOARD_REPORT,
+                                                        MAX_EVENTS_PER_GAMEPAD_REPORT})];
+    size_t eventCountInBuffer = 0;
+    size_t drainedEvents = 0;
+
+    BatchSizer batchSizer(pipeline.batchPolicy);
+    sink.setInjectionStats(&pipeline.injection);
+
+    // Merges the device queues back into capture order
+    OrderedReportDrain drain;
+    TraceRecorder* recorder = pipeline.recorder;
+
+    // Last known device states to avoid redundant events
+    MouseReport lastMouseState;
+    KeyboardReport lastKeyboardState;
+    GamepadReport lastGamepadState;
+
+    // Set while sends come up short, so a failing device is reported once
+    bool sinkFailing = false;
+
+    // Inject the buffered events and record when they left
+    auto sendBuffer = [&]() {
+        size_t accepted = sink.send(eventBuffer, eventCountInBuffer);
+        if (accepted < eventCountInBuffer) {
+            pipeline.injection.rejectedEvents.fetch_add(eventCountInBuffer - accepted,
+                                                        std::memory_order_relaxed);
+            if (!sinkFailing) {
+                LogRecord record{};
+                record.message = LogMessage::SINK_REJECTED;
+                record.count = eventCountInBuffer - accepted;
+                pipeline.logger.post(record);
+            }
+        }
+        sinkFailing = accepted < eventCountInBuffer;
+        drainedEvents += eventCountInBuffer;
+        uint64_t injectNs = MonotonicNanos();
+        for (size_t i = 0; i < eventCountInBuffer; i++) {
+            const InputEvent& event = eventBuffer[i];
+            LatencyDevice device = event.type == InputEventType::KEY ? LatencyDevice::KEYBOARD
+                                   : IsGamepadEvent(event)           ? LatencyDevice::GAMEPAD
+                                                                     : LatencyDevice::MOUSE;
+            if (event.captureNs != 0 && event.captureNs <= event.dequeueNs) {
+                pipeline.latency.at(device, LatencyStage::CAPTURE_TO_DEQUEUE)
+                    .record(event.dequeueNs - event.captureNs);
+            }
+            pipeline.latency.at(device, LatencyStage::DEQUEUE_TO_INJECT)
+                .record(injectNs - event.dequeueNs);
+        }
+        eventCountInBuffer = 0;
+    };
+
+    // Send once the batch reaches its target or its oldest event has been
+    // held for the latency budget. Reports already queued are never waited
+    // for, so the budget only bounds translation time within a long drain.
+    auto flushIfDue = [&]() {
+        if (eventCountInBuffer > 0 &&
+            batchSizer.shouldFlush(eventCountInBuffer, eventBuffer[0].dequeueNs, MonotonicNanos())) {
+            sendBuffer();
+        }
+    };
+
+    while (pipeline.running) {
+        // Clear event buffer
+        eventCountInBuffer = 0;
+        drainedEvents = 0;
+
+        // Drain every queue in one bulk pop each and translate in capture order
+        uint32_t watermark = pipeline.publishedSequence.load(std::memory_order_acquire);
+        size_t reportCount = drain.drain(
+            pipeline.mouseQueue, pipeline.keyboardQueue, pipeline.gamepadQueue, watermark,
+            [&](const MouseReport& report) {
+                if (recorder)
+                    recorder->record(report, drain.dequeueNs());
+                size_t translated = TranslateMouseReport(report, lastMouseState, drain.dequeueNs(),
+                                                         eventBuffer + eventCountInBuffer);
+                eventCountInBuffer = CoalesceWheelEvents(eventBuffer, eventCountInBuffer,
+                                                         eventCountInBuffer + translated);
+                flushIfDue();
+            },
+            [&](const KeyboardReport& report) {
+                if (recorder)
+                    recorder->record(report, drain.dequeueNs());
+                eventCountInBuffer += TranslateKeyboardReport(report, lastKeyboardState, drain.dequeueNs(),
+                                                              eventBuffer + eventCountInBuffer);
+                flushIfDue();
+            },
+            [&](const GamepadReport& report) {
+                if (recorder)
+                    recorder->record(report, drain.dequeueNs());
+                eventCountInBuffer += TranslateGamepadReport(report, lastGamepadState, drain.dequeueNs(),
+                                                             eventBuffer + eventCountInBuffer);
+                flushIfDue();
+            });
+
+        bool didProcess = reportCount > 0;
+        eventCount += static_cast<int>(reportCount);
+
+        // Send any remaining inputs
+        if (eventCountInBuffer > 0) {
+            sendBuffer();
+        }
+        pipeline.sentSequence.store(watermark, std::memory_order_release);
+        if (drainedEvents > 0) {
+            batchSizer.update(drainedEvents);
+        }
+
+        // Performance monitoring
+        if (pipeline.enableProfiling.load(std::memory_order_relaxed)) {
+            frameCount++;
+            auto now = std::chrono::high_resolution_clock::now();
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastProfileTime).count();
+
+            if (elapsed >= 1000) {
+                double fps = frameCount * 1000.0 / elapsed;
+                double eventsPerSec = eventCount * 1000.0 / elapsed;
+                // Formatting and histogram snapshots happen on the logger thread
+                LogRecord record{};
+                record.message = LogMessage::PERFORMANCE;
+                record.performance.fps = fps;
+                record.performance.eventsPerSec = eventsPerSec;
+                record.performance.coalesced = pipeline.mouseQueue.coalescedCount();
+                record.performance.dropped = pipeline.mouseQueue.droppedCount();
+                record.performance.batchTarget = static_cast<uint32_t>(batchSizer.target());
+                pipeline.logger.post(record);
+
+                record = LogRecord{};
+                record.message = LogMessage::PROFILE_REPORT;
+                record.histograms.latency = &pipeline.latency;
+                record.histograms.injection = &pipeline.injection;
+                record.histograms.captureCallback = &pipeline.captureCallbackNs;
+                pipeline.logger.post(record);
+
+                frameCount = 0;
+                eventCount = 0;
+                lastProfileTime = now;
+            }
+        }
+
+        // Wait for new reports if none were processed
+        if (!didProcess) {
+            pipeline.wakeSignal.wait(pipeline.waitMode, pipeline.spinBudget, IDLE_WAIT_TIMEOUT, [&] {
+                return pipeline.publishedSequence.load(std::memory_order_acquire) != watermark ||
+                       !pipeline.running.load(std::memory_order_relaxed);
+            });
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+
+#include "async_logger.h"
+#include "batch_sizer.h"
+#include "input_backend.h"
+#include "latency_histogram.h"
+#include "report_queue.h"
+#include "trace_recorder.h"
+#include "wake_signal.h"
+
+// Shared state between the capture sources and the processing thread
+struct InputPipeline {
+    MouseQueue mouseQueue;
+    KeyboardQueue keyboardQueue;
+    GamepadQueue gamepadQueue;
+
+    // Capture-order stamping: the producer takes a sequence number per
+    // report and publishes it once the report is queued. Every push must
+    // come from one thread at a time, or a later report can be published
+    // before an earlier one lands (see ordered_drain.h).
+    std::atomic<uint32_t> nextSequence{0};
+    std::atomic<uint32_t> publishedSequence{0};
+
+    // Watermark of the processing thread's last completed pass: every report
+    // up to it has been handed to the sink or was dropped by its queue
+    std::atomic<uint32_t> sentSequence{0};
+
+    bool pushMouse(MouseReport& report) {
+        report.sequence = nextSequence.fetch_add(1, std::memory_order_relaxed) + 1;
+        bool queued = mouseQueue.push(report);
+        publishedSequence.store(report.sequence, std::memory_order_release);
+        wakeSignal.notify();
+        return queued;
+    }
+
+    bool pushKeyboard(KeyboardReport& report) {
+        report.sequence = nextSequence.fetch_add(1, std::memory_order_relaxed) + 1;
+        bool queued = keyboardQueue.push(report);
+        publishedSequence.store(report.sequence, std::memory_order_release);
+        wakeSignal.notify();
+        return queued;
+    }
+
+    bool pushGamepad(GamepadReport& report) {
+        report.sequence = nextSequence.fetch_add(1, std::memory_order_relaxed) + 1;
+        bool queued = gamepadQueue.push(report);
+        publishedSequence.store(report.sequence, std::memory_order_release);
+        wakeSignal.notify();
+        return queued;
+    }
+
+    // Wakes the processing thread when it is parked on empty queues
+    WakeSignal wakeSignal;
+    WaitMode waitMode = WaitMode::HYBRID;
+    std::chrono::nanoseconds spinBudget = DEFAULT_SPIN_BUDGET;
+
+    // Injection batching, read when the processing thread starts
+    BatchPolicy batchPolicy;
+
+    // Written by the processing thread, snapshot from anywhere
+    PipelineLatency latency;
+    InjectionStats injection;
+
+    // Time spent inside capture callbacks that run on borrowed threads
+    // (the Windows low-level hooks), written by the capturing thread
+    LatencyHistogram captureCallbackNs;
+
+    // Console output from the capture and processing threads goes through
+    // here; started and stopped by main
+    AsyncLogger logger;
+
+    // Optional trace of every dequeued report (--record), set before the
+    // processing thread starts and closed after it exits
+    TraceRecorder* recorder = nullptr;
+
+    std::atomic<bool> running{true};
+    std::atomic<bool> blockFeedback{false};
+    std::atomic<bool> enableProfiling{false};
+};
+
+// Program control keys (F12 blocking, F11 profiling, Escape exit).
+// Returns true if the key was consumed and should not be forwarded.
+bool HandleControlKey(InputPipeline& pipeline, uint8_t usage);
+
+// Whether HandleControlKey acts on the usage, without acting on it. Cheap
+// enough for capture callbacks that must decide on the spot to swallow a
+// key and leave the handling to another thread.
+bool IsControlKey(uint8_t usage);
+
+// Report -> injection event translation. Each returns the number of
+// events written to out, which must have room for the worst case.
+// Mouse worst case: motion, all five buttons and both wheel axes
+constexpr size_t MAX_EVENTS_PER_MOUSE_REPORT = 1 + MOUSE_BUTTON_COUNT + 2;
+constexpr size_t MAX_EVENTS_PER_KEYBOARD_REPORT = KeyboardReport::MAX_TRANSITIONS;
+constexpr size_t MAX_EVENTS_PER_GAMEPAD_REPORT = GAMEPAD_AXIS_COUNT + GAMEPAD_BUTTON_COUNT;
+
+// Events carry the report's capture time and the given dequeue time, and
+// the last one is marked endOfReport.
+size_t TranslateMouseReport(const MouseReport& report, MouseReport& lastState,
+                            uint64_t dequeueNs, InputEvent* out);
+
+// Diffs against the previous report and emits only the keys that changed:
+// key-ups, modifier-ups, modifier-downs, then key-downs. Instantiated for
+// BootKeyboardReport and NkroKeyboardReport.
+template <typename Report>
+size_t TranslateKeyboardReport(const Report& report, Report& lastState,
+                               uint64_t dequeueNs, InputEvent* out);
+
+// Emits changed axes, then changed buttons
+size_t TranslateGamepadReport(const GamepadReport& report, GamepadReport& lastState,
+                              uint64_t dequeueNs, InputEvent* out);
+
+// High-performance processing loop, runs until pipeline.running is cleared
+void ProcessInputEvents(InputPipeline& pipeline, InputSink& sink);
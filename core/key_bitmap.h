@@ -0,0 +1,98 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "keycodes.h"
+
+inline unsigned CountTrailingZeros(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(value));
+#endif
+}
+
+inline unsigned PopCount(uint64_t value) {
+#ifdef _MSC_VER
+    return static_cast<unsigned>(__popcnt64(value));
+#else
+    return static_cast<unsigned>(__builtin_popcountll(value));
+#endif
+}
+
+// 256-bit set of HID keyboard usages. Modifier usages 0xE0-0xE7 land in
+// bits 32-39 of the last word, so the boot modifier byte maps onto them
+// with a single shift.
+struct KeyBitmap {
+    static constexpr unsigned MODIFIER_WORD = HID_USAGE_LCTRL / 64;
+    static constexpr unsigned MODIFIER_SHIFT = HID_USAGE_LCTRL % 64;
+    static constexpr uint64_t MODIFIER_MASK = uint64_t(0xFF) << MODIFIER_SHIFT;
+
+    uint64_t words[4] = {0, 0, 0, 0};
+
+    void set(uint8_t usage) { words[usage >> 6] |= uint64_t(1) << (usage & 63); }
+    void clear(uint8_t usage) { words[usage >> 6] &= ~(uint64_t(1) << (usage & 63)); }
+    void assign(uint8_t usage, bool down) { down ? set(usage) : clear(usage); }
+    bool test(uint8_t usage) const { return (words[usage >> 6] >> (usage & 63)) & 1; }
+
+    uint8_t modifiers() const {
+        return static_cast<uint8_t>(words[MODIFIER_WORD] >> MODIFIER_SHIFT);
+    }
+
+    void setModifiers(uint8_t modifiers) {
+        words[MODIFIER_WORD] = (words[MODIFIER_WORD] & ~MODIFIER_MASK) |
+                               (uint64_t(modifiers) << MODIFIER_SHIFT);
+    }
+
+    // Same set with the modifier usages removed
+    KeyBitmap withoutModifiers() const {
+        KeyBitmap result = *this;
+        result.words[MODIFIER_WORD] &= ~MODIFIER_MASK;
+        return result;
+    }
+
+    bool empty() const { return (words[0] | words[1] | words[2] | words[3]) == 0; }
+
+    unsigned count() const {
+        return PopCount(words[0]) + PopCount(words[1]) + PopCount(words[2]) + PopCount(words[3]);
+    }
+
+    // Visits set usages in ascending order, stopping early if fn returns false
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (unsigned w = 0; w < 4; w++) {
+            uint64_t bits = words[w];
+            while (bits) {
+                unsigned bit = CountTrailingZeros(bits);
+                bits &= bits - 1;
+                if (!fn(static_cast<uint8_t>(w * 64 + bit)))
+                    return;
+            }
+        }
+    }
+
+    friend KeyBitmap operator&(const KeyBitmap& a, const KeyBitmap& b) {
+        KeyBitmap r;
+        for (unsigned w = 0; w < 4; w++) r.words[w] = a.words[w] & b.words[w];
+        return r;
+    }
+
+    // Bits in a that are not in b
+    friend KeyBitmap operator-(const KeyBitmap& a, const KeyBitmap& b) {
+        KeyBitmap r;
+        for (unsigned w = 0; w < 4; w++) r.words[w] = a.words[w] & ~b.words[w];
+        return r;
+    }
+
+    friend bool operator==(const KeyBitmap& a, const KeyBitmap& b) {
+        return a.words[0] == b.words[0] && a.words[1] == b.words[1] &&
+               a.words[2] == b.words[2] && a.words[3] == b.words[3];
+    }
+};
+
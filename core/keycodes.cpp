@@ -0,0 +1,159 @@
+#include "keycodes.h"
+
+#include <array>
+
+namespace {
+
+// One row per key: HID usage, Windows virtual-key code, evdev KEY_* code.
+// A zero VK or evdev code means the key has no mapping on that platform.
+struct KeyCodeEntry {
+    uint8_t usage;
+    uint8_t vk;
+    uint16_t evdev;
+};
+
+constexpr KeyCodeEntry KEY_CODE_TABLE[] = {
+    // Letters
+    {0x04, 'A', 30}, {0x05, 'B', 48}, {0x06, 'C', 46}, {0x07, 'D', 32},
+    {0x08, 'E', 18}, {0x09, 'F', 33}, {0x0A, 'G', 34}, {0x0B, 'H', 35},
+    {0x0C, 'I', 23}, {0x0D, 'J', 36}, {0x0E, 'K', 37}, {0x0F, 'L', 38},
+    {0x10, 'M', 50}, {0x11, 'N', 49}, {0x12, 'O', 24}, {0x13, 'P', 25},
+    {0x14, 'Q', 16}, {0x15, 'R', 19}, {0x16, 'S', 31}, {0x17, 'T', 20},
+    {0x18, 'U', 22}, {0x19, 'V', 47}, {0x1A, 'W', 17}, {0x1B, 'X', 45},
+    {0x1C, 'Y', 21}, {0x1D, 'Z', 44},
+
+    // Digits
+    {0x1E, '1', 2}, {0x1F, '2', 3}, {0x20, '3', 4}, {0x21, '4', 5},
+    {0x22, '5', 6}, {0x23, '6', 7}, {0x24, '7', 8}, {0x25, '8', 9},
+    {0x26, '9', 10}, {0x27, '0', 11},
+
+    // Editing and punctuation
+    {0x28, 0x0D, 28},   // Enter
+    {0x29, 0x1B, 1},    // Escape
+    {0x2A, 0x08, 14},   // Backspace
+    {0x2B, 0x09, 15},   // Tab
+    {0x2C, 0x20, 57},   // Space
+    {0x2D, 0xBD, 12},   // Minus
+    {0x2E, 0xBB, 13},   // Equal
+    {0x2F, 0xDB, 26},   // Left bracket
+    {0x30, 0xDD, 27},   // Right bracket
+    {0x31, 0xDC, 43},   // Backslash
+    {0x33, 0xBA, 39},   // Semicolon
+    {0x34, 0xDE, 40},   // Apostrophe
+    {0x35, 0xC0, 41},   // Grave
+    {0x36, 0xBC, 51},   // Comma
+    {0x37, 0xBE, 52},   // Period
+    {0x38, 0xBF, 53},   // Slash
+    {0x39, 0x14, 58},   // Caps Lock
+
+    // Function keys
+    {0x3A, 0x70, 59}, {0x3B, 0x71, 60}, {0x3C, 0x72, 61}, {0x3D, 0x73, 62},
+    {0x3E, 0x74, 63}, {0x3F, 0x75, 64}, {0x40, 0x76, 65}, {0x41, 0x77, 66},
+    {0x42, 0x78, 67}, {0x43, 0x79, 68}, {0x44, 0x7A, 87}, {0x45, 0x7B, 88},
+
+    // Navigation block
+    {0x46, 0x2C, 99},   // Print Screen
+    {0x47, 0x91, 70},   // Scroll Lock
+    {0x48, 0x13, 119},  // Pause
+    {0x49, 0x2D, 110},  // Insert
+    {0x4A, 0x24, 102},  // Home
+    {0x4B, 0x21, 104},  // Page Up
+    {0x4C, 0x2E, 111},  // Delete
+    {0x4D, 0x23, 107},  // End
+    {0x4E, 0x22, 109},  // Page Down
+    {0x4F, 0x27, 106},  // Right
+    {0x50, 0x25, 105},  // Left
+    {0x51, 0x28, 108},  // Down
+    {0x52, 0x26, 103},  // Up
+
+    // Keypad
+    {0x53, 0x90, 69},   // Num Lock
+    {0x54, 0x6F, 98},   // Keypad /
+    {0x55, 0x6A, 55},   // Keypad *
+    {0x56, 0x6D, 74},   // Keypad -
+    {0x57, 0x6B, 78},   // Keypad +
+    {0x58, 0x00, 96},   // Keypad Enter (shares VK_RETURN on Windows)
+    {0x59, 0x61, 79}, {0x5A, 0x62, 80}, {0x5B, 0x63, 81},
+    {0x5C, 0x64, 75}, {0x5D, 0x65, 76}, {0x5E, 0x66, 77},
+    {0x5F, 0x67, 71}, {0x60, 0x68, 72}, {0x61, 0x69, 73},
+    {0x62, 0x60, 82},   // Keypad 0
+    {0x63, 0x6E, 83},   // Keypad .
+
+    {0x64, 0xE2, 86},   // Non-US backslash
+    {0x65, 0x5D, 127},  // Application
+
+    // F13-F24
+    {0x68, 0x7C, 183}, {0x69, 0x7D, 184}, {0x6A, 0x7E, 185}, {0x6B, 0x7F, 186},
+    {0x6C, 0x80, 187}, {0x6D, 0x81, 188}, {0x6E, 0x82, 189}, {0x6F, 0x83, 190},
+    {0x70, 0x84, 191}, {0x71, 0x85, 192}, {0x72, 0x86, 193}, {0x73, 0x87, 194},
+
+    // Modifiers
+    {0xE0, 0xA2, 29},   // Left Ctrl
+    {0xE1, 0xA0, 42},   // Left Shift
+    {0xE2, 0xA4, 56},   // Left Alt
+    {0xE3, 0x5B, 125},  // Left GUI
+    {0xE4, 0xA3, 97},   // Right Ctrl
+    {0xE5, 0xA1, 54},   // Right Shift
+    {0xE6, 0xA5, 100},  // Right Alt
+    {0xE7, 0x5C, 126},  // Right GUI
+};
+
+constexpr std::array<uint8_t, 256> BuildVkToUsage() {
+    std::array<uint8_t, 256> table{};
+    for (const KeyCodeEntry& entry : KEY_CODE_TABLE) {
+        if (entry.vk != 0) table[entry.vk] = entry.usage;
+    }
+    // Generic modifier VKs fold onto the left-hand keys
+    table[0x10] = 0xE1;  // VK_SHIFT
+    table[0x11] = 0xE0;  // VK_CONTROL
+    table[0x12] = 0xE2;  // VK_MENU
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> BuildUsageToVk() {
+    std::array<uint8_t, 256> table{};
+    for (const KeyCodeEntry& entry : KEY_CODE_TABLE) {
+        table[entry.usage] = entry.vk;
+    }
+    table[0x58] = 0x0D;  // Keypad Enter injects as Enter
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> BuildEvdevToUsage() {
+    std::array<uint8_t, 256> table{};
+    for (const KeyCodeEntry& entry : KEY_CODE_TABLE) {
+        if (entry.evdev != 0) table[entry.evdev] = entry.usage;
+    }
+    return table;
+}
+
+constexpr std::array<uint16_t, 256> BuildUsageToEvdev() {
+    std::array<uint16_t, 256> table{};
+    for (const KeyCodeEntry& entry : KEY_CODE_TABLE) {
+        table[entry.usage] = entry.evdev;
+    }
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> VK_TO_USAGE = BuildVkToUsage();
+constexpr std::array<uint8_t, 256> USAGE_TO_VK = BuildUsageToVk();
+constexpr std::array<uint8_t, 256> EVDEV_TO_USAGE = BuildEvdevToUsage();
+constexpr std::array<uint16_t, 256> USAGE_TO_EVDEV = BuildUsageToEvdev();
+
+}  // namespace
+
+uint8_t VkToHidUsage(uint8_t vk) {
+    return VK_TO_USAGE[vk];
+}
+
+uint8_t HidUsageToVk(uint8_t usage) {
+    return USAGE_TO_VK[usage];
+}
+
+uint8_t EvdevToHidUsage(uint16_t code) {
+    return code < EVDEV_TO_USAGE.size() ? EVDEV_TO_USAGE[code] : HID_USAGE_NONE;
+}
+
+uint16_t HidUsageToEvdev(uint8_t usage) {
+    return USAGE_TO_EVDEV[usage];
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+
+// HID keyboard usage IDs (page 0x07) used by the pipeline
+constexpr uint8_t HID_USAGE_NONE = 0x00;
+constexpr uint8_t HID_USAGE_ESCAPE = 0x29;
+constexpr uint8_t HID_USAGE_F11 = 0x44;
+constexpr uint8_t HID_USAGE_F12 = 0x45;
+constexpr uint8_t HID_USAGE_LCTRL = 0xE0;
+constexpr uint8_t HID_USAGE_RGUI = 0xE7;
+
+// Modifier usages 0xE0-0xE7 map onto the boot report modifier byte
+inline bool IsModifierUsage(uint8_t usage) {
+    return usage >= HID_USAGE_LCTRL && usage <= HID_USAGE_RGUI;
+}
+
+inline uint8_t ModifierBitForUsage(uint8_t usage) {
+    return static_cast<uint8_t>(1u << (usage - HID_USAGE_LCTRL));
+}
+
+// Windows virtual-key codes <-> HID usages. Returns 0 for unmapped codes.
+uint8_t VkToHidUsage(uint8_t vk);
+uint8_t HidUsageToVk(uint8_t usage);
+
+// Linux evdev KEY_* codes <-> HID usages. Returns 0 for unmapped codes.
+uint8_t EvdevToHidUsage(uint16_t code);
+uint16_t HidUsageToEvdev(uint8_t usage);
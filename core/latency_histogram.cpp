@@ -0,0 +1,95 @@
+#include "latency_histogram.h"
+
+#include <iomanip>
+#include <memory>
+#include <string>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+unsigned LatencyHistogram::CountLeadingZeros(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return 63 - static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_clzll(value));
+#endif
+}
+
+void LatencyHistogram::snapshot(Snapshot& out) const {
+    out.count = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        out.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+        out.count += out.counts[i];
+    }
+    out.max = m_max.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile(double p) const {
+    if (count == 0)
+        return 0;
+
+    // Rank of the requested percentile, at least the first sample
+    uint64_t rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(count) + 0.5);
+    if (rank < 1) rank = 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            uint64_t bound = BucketUpperBound(i);
+            return bound < max ? bound : max;
+        }
+    }
+    return max;
+}
+
+void PrintLatency(std::ostream& out, const char* label, const LatencyHistogram& histogram) {
+    // Snapshots are ~8 KB each, keep them off the caller's stack
+    auto snapshot = std::make_unique<LatencyHistogram::Snapshot>();
+    histogram.snapshot(*snapshot);
+    if (snapshot->count == 0)
+        return;
+
+    std::ios_base::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(1);
+    out << label << ": n=" << snapshot->count
+        << " p50 " << snapshot->percentile(50.0) / 1000.0
+        << " us, p99 " << snapshot->percentile(99.0) / 1000.0
+        << " us, p99.9 " << snapshot->percentile(99.9) / 1000.0
+        << " us, max " << snapshot->max / 1000.0 << " us\n";
+    out.flags(flags);
+}
+
+void PipelineLatency::print(std::ostream& out) const {
+    static const char* const DEVICE_NAMES[] = {"mouse", "keyboard", "gamepad"};
+    static const char* const STAGE_NAMES[] = {"capture->dequeue", "dequeue->inject"};
+
+    for (size_t device = 0; device < static_cast<size_t>(LatencyDevice::COUNT); device++) {
+        for (size_t stage = 0; stage < static_cast<size_t>(LatencyStage::COUNT); stage++) {
+            std::string label = std::string("Latency ") + DEVICE_NAMES[device] + " " + STAGE_NAMES[stage];
+            PrintLatency(out, label.c_str(), histograms[device][stage]);
+        }
+    }
+}
+
+void InjectionStats::print(std::ostream& out) const {
+    auto events = std::make_unique<LatencyHistogram::Snapshot>();
+    auto cost = std::make_unique<LatencyHistogram::Snapshot>();
+    eventsPerWrite.snapshot(*events);
+    writeNs.snapshot(*cost);
+    if (events->count == 0)
+        return;
+
+    std::ios_base::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(1);
+    out << "Injection: " << events->count << " writes, events/write p50 " << events->percentile(50.0)
+        << ", p99 " << events->percentile(99.0) << ", max " << events->max
+        << "; write p50 " << cost->percentile(50.0) / 1000.0
+        << " us, p99 " << cost->percentile(99.0) / 1000.0
+        << " us, max " << cost->max / 1000.0 << " us, "
+        << rejectedEvents.load(std::memory_order_relaxed) << " events rejected\n";
+    out.flags(flags);
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <ostream>
+#include <stddef.h>
+#include <stdint.h>
+
+// HDR-style log-linear latency histogram.
+//
+// Values below 32 ns get exact buckets; above that every power of two is
+// split into 16 linear sub-buckets, so any recorded value is reported within
+// ~6% over the full 64-bit range. A single writer (the processing thread)
+// records with relaxed loads/stores and no RMW; any thread may snapshot.
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BITS = 5;
+    static constexpr size_t SUB_COUNT = size_t(1) << SUB_BITS;
+    static constexpr size_t HALF_COUNT = SUB_COUNT / 2;
+    static constexpr size_t BUCKET_COUNT = SUB_COUNT + (64 - SUB_BITS) * HALF_COUNT;
+
+    struct Snapshot {
+        uint64_t counts[BUCKET_COUNT];
+        uint64_t count;
+        uint64_t max;
+
+        // Highest value equivalent to the given percentile (0-100)
+        uint64_t percentile(double p) const;
+    };
+
+    static size_t BucketIndex(uint64_t value) {
+        if (value < SUB_COUNT)
+            return static_cast<size_t>(value);
+        unsigned msb = 63 - CountLeadingZeros(value);
+        unsigned shift = msb - (SUB_BITS - 1);
+        size_t top = static_cast<size_t>(value >> shift);
+        return SUB_COUNT + (shift - 1) * HALF_COUNT + (top - HALF_COUNT);
+    }
+
+    static uint64_t BucketUpperBound(size_t index) {
+        if (index < SUB_COUNT)
+            return index;
+        size_t k = index - SUB_COUNT;
+        unsigned shift = static_cast<unsigned>(k / HALF_COUNT) + 1;
+        uint64_t top = (k % HALF_COUNT) + HALF_COUNT;
+        return ((top + 1) << shift) - 1;
+    }
+
+    void record(uint64_t value) {
+        std::atomic<uint64_t>& bucket = m_counts[BucketIndex(value)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        m_count.store(m_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (value > m_max.load(std::memory_order_relaxed))
+            m_max.store(value, std::memory_order_relaxed);
+    }
+
+    void snapshot(Snapshot& out) const;
+
+private:
+    static unsigned CountLeadingZeros(uint64_t value);
+
+    std::atomic<uint64_t> m_counts[BUCKET_COUNT] = {};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_max{0};
+};
+
+// Writes "<label>: n=... p50/p99/p99.9/max" in microseconds, nothing when
+// the histogram is empty
+void PrintLatency(std::ostream& out, const char* label, const LatencyHistogram& histogram);
+
+// Capture->dequeue and dequeue->inject histograms per device type
+enum class LatencyDevice : uint8_t { MOUSE, KEYBOARD, GAMEPAD, COUNT };
+enum class LatencyStage : uint8_t { CAPTURE_TO_DEQUEUE, DEQUEUE_TO_INJECT, COUNT };
+
+struct PipelineLatency {
+    LatencyHistogram histograms[static_cast<size_t>(LatencyDevice::COUNT)]
+                               [static_cast<size_t>(LatencyStage::COUNT)];
+
+    LatencyHistogram& at(LatencyDevice device, LatencyStage stage) {
+        return histograms[static_cast<size_t>(device)][static_cast<size_t>(stage)];
+    }
+
+    const LatencyHistogram& at(LatencyDevice device, LatencyStage stage) const {
+        return histograms[static_cast<size_t>(device)][static_cast<size_t>(stage)];
+    }
+
+    // Snapshots every histogram and writes p50/p99/p99.9/max in microseconds
+    void print(std::ostream& out) const;
+};
+
+// Per-syscall injection telemetry: how many events (or wire reports) each
+// SendInput/write call carried and how long the call took. Recorded by the
+// sinks on the processing thread.
+struct InjectionStats {
+    LatencyHistogram eventsPerWrite;
+    LatencyHistogram writeNs;
+    std::atomic<uint64_t> rejectedEvents{0};  // Events a sink could not inject
+
+    void record(size_t events, uint64_t elapsedNs) {
+        eventsPerWrite.record(events);
+        writeNs.record(elapsedNs);
+    }
+
+    // Writes p50/p99/max of both, with the write cost in microseconds
+    void print(std::ostream& out) const;
+};
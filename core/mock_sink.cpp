@@ -0,0 +1,25 @@
+#include "mock_sink.h"
+
+MockSink::MockSink(bool recordEvents) : m_recordEvents(recordEvents) {}
+
+bool MockSink::open() {
+    clear();
+    return true;
+}
+
+void MockSink::close() {}
+
+size_t MockSink::send(const InputEvent* events, size_t count) {
+    if (m_recordEvents) {
+        m_events.insert(m_events.end(), events, events + count);
+    }
+    m_eventCount += count;
+    m_batchCount++;
+    return count;
+}
+
+void MockSink::clear() {
+    m_events.clear();
+    m_eventCount = 0;
+    m_batchCount = 0;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+
+#include "input_backend.h"
+
+// In-memory sink for hosts without an injection device (CI, perf boxes).
+// Records every event so the pipeline can be inspected and benchmarked.
+class MockSink : public InputSink {
+public:
+    explicit MockSink(bool recordEvents = true);
+
+    const char* name() const override { return "mock"; }
+    bool open() override;
+    void close() override;
+    size_t send(const InputEvent* events, size_t count) override;
+
+    const std::vector<InputEvent>& events() const { return m_events; }
+    size_t eventCount() const { return m_eventCount; }
+    size_t batchCount() const { return m_batchCount; }
+    void clear();
+
+private:
+    bool m_recordEvents;
+    std::vector<InputEvent> m_events;
+    size_t m_eventCount = 0;
+    size_t m_batchCount = 0;
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdint.h>
+
+// Splits a 32-bit displacement into the fewest steps whose components all
+// lie within [-limit, limit], for output formats with narrow delta fields
+// (8/16-bit HID reports). Motion is spread evenly so the path stays
+// straight, and the steps always sum to exactly (dx, dy). emit(x, y) is
+// called once per step; zero motion emits nothing.
+template <typename Fn>
+void SplitMotion(int32_t dx, int32_t dy, int32_t limit, Fn&& emit) {
+    int64_t absX = dx < 0 ? -int64_t(dx) : dx;
+    int64_t absY = dy < 0 ? -int64_t(dy) : dy;
+    int64_t largest = absX > absY ? absX : absY;
+    int64_t steps = (largest + limit - 1) / limit;
+
+    for (int64_t i = 0; i < steps; i++) {
+        // Difference of consecutive prefix shares; the sum telescopes to dx
+        int64_t x = int64_t(dx) * (i + 1) / steps - int64_t(dx) * i / steps;
+        int64_t y = int64_t(dy) * (i + 1) / steps - int64_t(dy) * i / steps;
+        emit(static_cast<int32_t>(x), static_cast<int32_t>(y));
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "spsc_ring.h"
+
+// Bounded multi-producer/single-consumer ring buffer.
+//
+// Every slot carries a sequence number that says whose turn it is: a
+// producer claims a slot with one CAS on the tail and publishes it by
+// bumping the slot's sequence, the consumer frees it by advancing the
+// sequence a full lap. Producers never wait on each other or on the
+// consumer; a full ring fails the push.
+template <typename T, size_t N>
+class MpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "MpscRing capacity must be a power of two");
+
+public:
+    MpscRing() {
+        for (size_t i = 0; i < N; i++)
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    static constexpr size_t capacity() { return N; }
+
+    // Any thread
+    bool push(const T& item) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &m_slots[tail & MASK];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t lag = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(tail);
+            if (lag == 0) {
+                if (m_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+                    break;
+            } else if (lag < 0) {
+                return false;  // Ring is full
+            } else {
+                tail = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->item = item;
+        slot->sequence.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only. Stops at a slot that is claimed but not yet
+    // published, so items come out in claim order.
+    bool pop(T& item) {
+        Slot& slot = m_slots[m_head & MASK];
+        if (slot.sequence.load(std::memory_order_acquire) != m_head + 1)
+            return false;
+
+        item = slot.item;
+        slot.sequence.store(m_head + N, std::memory_order_release);
+        m_head++;
+        return true;
+    }
+
+private:
+    static constexpr size_t MASK = N - 1;
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+    // Shared by the producers
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_tail{0};
+
+    // Consumer-owned line
+    alignas(CACHE_LINE_SIZE) size_t m_head = 0;
+
+    alignas(CACHE_LINE_SIZE) Slot m_slots[N];
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <span>
+
+#include "clock.h"
+#include "report_queue.h"
+
+// Drains the per-device queues and visits reports in capture order.
+//
+// The capture side stamps each report with a global sequence number and
+// publishes it after the push. The watermark is a plain store, so this only
+// holds with a single producer thread; sources that capture on several
+// threads funnel their reports through one (see Win32HookSource). Only
+// reports up to the watermark read before draining are visited; anything
+// newer stays buffered for the next call, so a report pushed to one queue
+// while another was being popped is never injected ahead of an earlier one.
+class OrderedReportDrain {
+public:
+    template <typename MouseFn, typename KeyboardFn, typename GamepadFn>
+    size_t drain(MouseQueue& mouseQueue, KeyboardQueue& keyboardQueue, GamepadQueue& gamepadQueue,
+                 uint32_t watermark, MouseFn&& onMouse, KeyboardFn&& onKeyboard, GamepadFn&& onGamepad) {
+        m_mouseCount += mouseQueue.popBulk(std::span<MouseReport>(m_mouse).subspan(m_mouseCount));
+        m_keyboardCount += keyboardQueue.popBulk(std::span<KeyboardReport>(m_keyboard).subspan(m_keyboardCount));
+        m_gamepadCount += gamepadQueue.popBulk(std::span<GamepadReport>(m_gamepad).subspan(m_gamepadCount));
+        m_dequeueNs = MonotonicNanos();
+
+        size_t mouseIndex = 0;
+        size_t keyboardIndex = 0;
+        size_t gamepadIndex = 0;
+
+        while (true) {
+            bool mouseReady = mouseIndex < m_mouseCount &&
+                              !SequenceBefore(watermark, m_mouse[mouseIndex].sequence);
+            bool keyboardReady = keyboardIndex < m_keyboardCount &&
+                                 !SequenceBefore(watermark, m_keyboard[keyboardIndex].sequence);
+            bool gamepadReady = gamepadIndex < m_gamepadCount &&
+                                !SequenceBefore(watermark, m_gamepad[gamepadIndex].sequence);
+
+            // Oldest ready head wins
+            uint32_t mouseSequence = mouseReady ? m_mouse[mouseIndex].sequence : 0;
+            uint32_t keyboardSequence = keyboardReady ? m_keyboard[keyboardIndex].sequence : 0;
+            uint32_t gamepadSequence = gamepadReady ? m_gamepad[gamepadIndex].sequence : 0;
+
+            if (mouseReady && (!keyboardReady || !SequenceBefore(keyboardSequence, mouseSequence)) &&
+                (!gamepadReady || !SequenceBefore(gamepadSequence, mouseSequence))) {
+                onMouse(m_mouse[mouseIndex++]);
+            } else if (keyboardReady && (!gamepadReady || !SequenceBefore(gamepadSequence, keyboardSequence))) {
+                onKeyboard(m_keyboard[keyboardIndex++]);
+            } else if (gamepadReady) {
+                onGamepad(m_gamepad[gamepadIndex++]);
+            } else {
+                break;
+            }
+        }
+
+        // Carry reports past the watermark over to the next drain
+        std::copy(m_mouse + mouseIndex, m_mouse + m_mouseCount, m_mouse);
+        std::copy(m_keyboard + keyboardIndex, m_keyboard + m_keyboardCount, m_keyboard);
+        std::copy(m_gamepad + gamepadIndex, m_gamepad + m_gamepadCount, m_gamepad);
+        m_mouseCount -= mouseIndex;
+        m_keyboardCount -= keyboardIndex;
+        m_gamepadCount -= gamepadIndex;
+
+        return mouseIndex + keyboardIndex + gamepadIndex;
+    }
+
+    // When the current drain pulled its reports off the queues
+    uint64_t dequeueNs() const { return m_dequeueNs; }
+
+private:
+    // Room for a full ring and the mouse queue's coalesced report on top of
+    // as many carried over, so coalesced motion is never held back
+    MouseReport m_mouse[MouseQueue::capacity() * 2 + 2];
+    KeyboardReport m_keyboard[KeyboardQueue::capacity() * 2];
+    GamepadReport m_gamepad[GamepadQueue::capacity() * 2];
+    size_t m_mouseCount = 0;
+    size_t m_keyboardCount = 0;
+    size_t m_gamepadCount = 0;
+    uint64_t m_dequeueNs = 0;
+};
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <span>
+
+#include "hid_reports.h"
+#include "spsc_ring.h"
+
+// Mouse report queue with a motion-coalescing overflow policy.
+//
+// Once the ring is nearly full, motion is folded into a shared accumulator
+// instead of being dropped, so total displacement is preserved exactly under
+// overload. The last MOTION_RESERVE slots are kept for button and wheel
+// transitions, which are never merged: before one is queued, any coalesced
+// motion is pushed ahead of it to keep ordering.
+//
+// A coalesced report carries the sequence, timestamp and buttons of the
+// newest report folded into it. The consumer may also take the accumulator
+// itself; it then places the report among the ring's reports by sequence,
+// since reports queued before the folds may still be waiting in the ring.
+class MouseQueue {
+public:
+    static constexpr size_t MOTION_RESERVE = 4;
+
+    static constexpr size_t capacity() { return MAX_QUEUE_SIZE; }
+
+    // Producer side. Returns false only when a button/wheel transition had
+    // to be dropped; its motion is still kept.
+    bool push(const MouseReport& report) {
+        bool motionOnly = report.wheel == 0 && report.hwheel == 0 &&
+                          report.buttons == m_lastButtons;
+        size_t reserve = motionOnly ? MOTION_RESERVE : 0;
+
+        // Coalesced motion goes first, leaving room for this report
+        if (m_overflowed && !flushCoalesced(reserve + 1)) {
+            // Ring is still backed up
+            accumulate(report);
+            return countOverflow(motionOnly);
+        }
+
+        if (m_ring.push(report, reserve)) {
+            m_lastButtons = report.buttons;
+            return true;
+        }
+
+        accumulate(report);
+        m_overflowed = true;
+        return countOverflow(motionOnly);
+    }
+
+    // Consumer side. Drains the ring, with any coalesced motion in its
+    // place by sequence. Needs room for one report more than the ring holds
+    // to always deliver the coalesced report in the same call.
+    size_t popBulk(std::span<MouseReport> out) {
+        if (out.empty())
+            return 0;
+
+        if (!m_holding)
+            m_holding = takeCoalesced(m_held);
+        if (!m_holding)
+            return m_ring.popBulk(out);
+
+        // Everything queued before the folds is in the ring by now, and
+        // anything queued after them has a higher sequence
+        size_t count = m_ring.popBulk(out.first(out.size() - 1));
+        size_t position = 0;
+        while (position < count && SequenceBefore(out[position].sequence, m_held.sequence))
+            position++;
+        if (position == count && count == out.size() - 1 && !m_ring.isEmpty())
+            return count;  // Older reports may still be queued
+
+        std::copy_backward(out.begin() + position, out.begin() + count, out.begin() + count + 1);
+        out[position] = m_held;
+        m_holding = false;
+        return count + 1;
+    }
+
+    // Consumer side
+    bool isEmpty() const {
+        return m_ring.isEmpty() && !m_holding &&
+               !(m_foldState.load(std::memory_order_acquire) & FOLD_HAS_MOTION);
+    }
+
+    // Reports folded into the accumulator / transitions lost to overload
+    uint64_t coalescedCount() const { return m_coalescedCount.load(std::memory_order_relaxed); }
+    uint64_t droppedCount() const { return m_droppedCount.load(std::memory_order_relaxed); }
+
+private:
+    // The accumulator is two slots and a state word: bit 0 picks the current
+    // slot, bit 1 says it holds motion, and the rest counts updates. The
+    // producer folds by writing the sum into the other slot and switching to
+    // it; the consumer takes by copying the current slot and clearing the
+    // motion bit. Both switch with a compare-exchange, so a copy taken while
+    // the producer moved on is thrown away, and the slot being read is never
+    // the one being written unless the exchange is going to fail.
+    static constexpr uint64_t FOLD_SLOT = 1;
+    static constexpr uint64_t FOLD_HAS_MOTION = 2;
+    static constexpr uint64_t FOLD_UPDATE = 4;
+
+    struct FoldSlot {
+        std::atomic<int64_t> motion{0};
+        std::atomic<uint64_t> timestamp{0};
+        std::atomic<uint32_t> sequence{0};
+        std::atomic<uint32_t> source{0};  // buttons | device << 8
+    };
+
+    // x and y share one 64-bit word as y * 2^32 + x, so the sum decodes
+    // exactly while |x| < 2^31.
+    static int64_t Pack(int32_t x, int32_t y) {
+        return static_cast<int64_t>(y) * (int64_t(1) << 32) + x;
+    }
+
+    static void Unpack(int64_t packed, int32_t& x, int32_t& y) {
+        x = static_cast<int32_t>(static_cast<uint32_t>(packed));
+        y = static_cast<int32_t>((packed - x) / (int64_t(1) << 32));
+    }
+
+    // Producer: fold a report's motion into the accumulator. buttons is the
+    // state the motion happened under.
+    void fold(int64_t motion, uint32_t sequence, uint64_t timestamp, uint8_t buttons, uint16_t device) {
+        uint64_t state = m_foldState.load(std::memory_order_acquire);
+        while (true) {
+            const FoldSlot& current = m_slots[state & FOLD_SLOT];
+            FoldSlot& next = m_slots[(state & FOLD_SLOT) ^ 1];
+            int64_t sum = (state & FOLD_HAS_MOTION) ? current.motion.load(std::memory_order_relaxed) : 0;
+            next.motion.store(sum + motion, std::memory_order_relaxed);
+            next.timestamp.store(timestamp, std::memory_order_relaxed);
+            next.sequence.store(sequence, std::memory_order_relaxed);
+            next.source.store(buttons | static_cast<uint32_t>(device) << 8, std::memory_order_relaxed);
+
+            uint64_t updated = ((state & ~(FOLD_SLOT | FOLD_HAS_MOTION)) + FOLD_UPDATE) |
+                               FOLD_HAS_MOTION | ((state & FOLD_SLOT) ^ 1);
+            if (m_foldState.compare_exchange_weak(state, updated, std::memory_order_acq_rel,
+                                                  std::memory_order_acquire))
+                return;
+        }
+    }
+
+    void accumulate(const MouseReport& report) {
+        if (report.x != 0 || report.y != 0)
+            fold(Pack(report.x, report.y), report.sequence, report.timestamp, m_lastButtons, report.device);
+    }
+
+    // Either side: empty the accumulator into a motion-only report
+    bool take(MouseReport& report) {
+        uint64_t state = m_foldState.load(std::memory_order_acquire);
+        while (state & FOLD_HAS_MOTION) {
+            const FoldSlot& current = m_slots[state & FOLD_SLOT];
+            int64_t motion = current.motion.load(std::memory_order_relaxed);
+            uint64_t timestamp = current.timestamp.load(std::memory_order_relaxed);
+            uint32_t sequence = current.sequence.load(std::memory_order_relaxed);
+            uint32_t source = current.source.load(std::memory_order_relaxed);
+
+            uint64_t emptied = ((state & ~FOLD_HAS_MOTION) + FOLD_UPDATE);
+            if (m_foldState.compare_exchange_weak(state, emptied, std::memory_order_acq_rel,
+                                                  std::memory_order_acquire)) {
+                report = MouseReport();
+                Unpack(motion, report.x, report.y);
+                report.timestamp = timestamp;
+                report.sequence = sequence;
+                report.buttons = static_cast<uint8_t>(source);
+                report.device = static_cast<uint16_t>(source >> 8);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool countOverflow(bool motionOnly) {
+        if (motionOnly) {
+            m_coalescedCount.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Producer: move coalesced motion into the ring ahead of newer reports
+    bool flushCoalesced(size_t reserve) {
+        MouseReport report;
+        if (take(report) && !m_ring.push(report, reserve)) {
+            // Nothing was folded since the take, so this restores it as is
+            fold(Pack(report.x, report.y), report.sequence, report.timestamp, report.buttons, report.device);
+            return false;
+        }
+
+        m_overflowed = false;
+        return true;
+    }
+
+    // Consumer: the report is held until no older report can be queued
+    bool takeCoalesced(MouseReport& report) {
+        if (!(m_foldState.load(std::memory_order_relaxed) & FOLD_HAS_MOTION))
+            return false;
+        return take(report);
+    }
+
+    SpscRing<MouseReport, MAX_QUEUE_SIZE> m_ring;
+
+    // Shared accumulator and overload counters
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_foldState{0};
+    std::atomic<uint64_t> m_coalescedCount{0};
+    std::atomic<uint64_t> m_droppedCount{0};
+    FoldSlot m_slots[2];
+
+    // Producer-owned
+    alignas(CACHE_LINE_SIZE) uint8_t m_lastButtons = 0;
+    bool m_overflowed = false;
+
+    // Consumer-owned: coalesced motion taken but not yet delivered
+    alignas(CACHE_LINE_SIZE) MouseReport m_held;
+    bool m_holding = false;
+};
+
+using KeyboardQueue = SpscRing<KeyboardReport, MAX_QUEUE_SIZE>;
+
+// Gamepad reports are full-state snapshots; a producer that finds the ring
+// full keeps its latest state and retries rather than coalescing
+using GamepadQueue = SpscRing<GamepadReport, MAX_QUEUE_SIZE>;
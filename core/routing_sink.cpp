@@ -0,0 +1,49 @@
+#include "routing_sink.h"
+
+namespace {
+
+bool IsGamepadEvent(const InputEvent& event) {
+    return event.type == InputEventType::GAMEPAD_AXIS || event.type == InputEventType::GAMEPAD_BUTTON;
+}
+
+}  // namespace
+
+bool RoutingSink::open() {
+    if (!m_primary.open())
+        return false;
+    if (!m_gamepad.open()) {
+        m_primary.close();
+        return false;
+    }
+    return true;
+}
+
+void RoutingSink::close() {
+    m_gamepad.close();
+    m_primary.close();
+}
+
+void RoutingSink::setInjectionStats(InjectionStats* stats) {
+    m_primary.setInjectionStats(stats);
+    m_gamepad.setInjectionStats(stats);
+}
+
+size_t RoutingSink::send(const InputEvent* events, size_t count) {
+    size_t sent = 0;
+
+    while (sent < count) {
+        bool gamepad = IsGamepadEvent(events[sent]);
+        size_t runEnd = sent + 1;
+        while (runEnd < count && IsGamepadEvent(events[runEnd]) == gamepad)
+            runEnd++;
+
+        InputSink& sink = gamepad ? m_gamepad : m_primary;
+        size_t runLength = runEnd - sent;
+        size_t runSent = sink.send(events + sent, runLength);
+        sent += runSent;
+        if (runSent < runLength)
+            return sent;
+    }
+
+    return count;
+}
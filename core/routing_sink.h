@@ -0,0 +1,21 @@
+#pragma once
+
+#include "input_backend.h"
+
+// Sends gamepad events to their own sink and everything else to the primary
+// sink. Consecutive events with the same destination go out as one batch, so
+// capture order is kept across the two devices.
+class RoutingSink : public InputSink {
+public:
+    RoutingSink(InputSink& primary, InputSink& gamepad) : m_primary(primary), m_gamepad(gamepad) {}
+
+    const char* name() const override { return "routing"; }
+    bool open() override;
+    void close() override;
+    size_t send(const InputEvent* events, size_t count) override;
+    void setInjectionStats(InjectionStats* stats) override;
+
+private:
+    InputSink& m_primary;
+    InputSink& m_gamepad;
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <span>
+#include <stddef.h>
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// Single-producer/single-consumer ring buffer.
+//
+// Indices run freely and are masked on access, so all N slots are usable and
+// no modulo is needed. Producer and consumer indices sit on their own cache
+// lines, and each side keeps a private copy of the opposite index: the shared
+// line is only read when the cached copy says the ring is full (producer) or
+// empty (consumer).
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    static constexpr size_t capacity() { return N; }
+
+    // Fails unless more than `reserve` slots are free, which lets callers
+    // keep headroom for items that must not be coalesced or dropped.
+    bool push(const T& item, size_t reserve = 0) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead >= N - reserve) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead >= N - reserve)
+                return false;  // Ring is full
+        }
+
+        m_items[tail & MASK] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail)
+                return false;  // Ring is empty
+        }
+
+        item = m_items[head & MASK];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Pushes as many items as fit with a single release store; the shared
+    // head is read at most once. Returns the number of items pushed.
+    size_t pushBulk(std::span<const T> items) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        size_t free = N - (tail - m_cachedHead);
+        if (free < items.size()) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            free = N - (tail - m_cachedHead);
+        }
+
+        size_t count = std::min(free, items.size());
+        if (count == 0)
+            return 0;
+
+        // Copy in at most two contiguous runs around the wrap point
+        size_t first = std::min(count, N - (tail & MASK));
+        std::copy_n(items.data(), first, m_items + (tail & MASK));
+        std::copy_n(items.data() + first, count - first, m_items);
+
+        m_tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // Pops up to out.size() items with a single release store; the shared
+    // tail is read at most once. Returns the number of items popped.
+    size_t popBulk(std::span<T> out) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        size_t available = m_cachedTail - head;
+        if (available < out.size()) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            available = m_cachedTail - head;
+        }
+
+        size_t count = std::min(available, out.size());
+        if (count == 0)
+            return 0;
+
+        size_t first = std::min(count, N - (head & MASK));
+        std::copy_n(m_items + (head & MASK), first, out.data());
+        std::copy_n(m_items, count - first, out.data() + first);
+
+        m_head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    bool isEmpty() const {
+        return m_head.load(std::memory_order_acquire) ==
+               m_tail.load(std::memory_order_acquire);
+    }
+
+    size_t size() const {
+        return m_tail.load(std::memory_order_acquire) -
+               m_head.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr size_t MASK = N - 1;
+
+    // Producer-owned line
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_tail{0};
+    size_t m_cachedHead = 0;
+
+    // Consumer-owned line
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_head{0};
+    size_t m_cachedTail = 0;
+
+    alignas(CACHE_LINE_SIZE) T m_items[N];
+};
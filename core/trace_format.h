@@ -0,0 +1,167 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "hid_reports.h"
+
+// On-disk layout of an input trace (--record). Everything is fixed-size and
+// in host byte order (little-endian on every supported target), so a
+// mapped file is used in place:
+//
+//   [0, 4096)            TraceHeader, zero padded
+//   [4096, ...)          TraceRecord[recordCount], 64 bytes each
+//   [indexOffset, ...)   TraceIndexEntry[indexCount]
+//
+// Records are appended in dequeue order; a report lost to overload shows
+// up as a gap in the sequence numbers. The header counts and the index are
+// written when the recorder closes. A trace cut short by a crash keeps its
+// records and is read by file size instead.
+
+constexpr char TRACE_MAGIC[8] = {'H', 'I', 'D', 'T', 'R', 'A', 'C', 'E'};
+constexpr uint32_t TRACE_VERSION = 1;
+constexpr size_t TRACE_HEADER_SIZE = 4096;  // Records start page aligned
+
+// Records per write, and per index entry
+constexpr size_t TRACE_RECORDS_PER_BLOCK = 4096;
+
+constexpr uint32_t TRACE_FLAG_COMPLETE = 0x01;  // Counts and index are valid
+constexpr uint32_t TRACE_FLAG_NKRO = 0x02;      // Recorded from NKRO keyboard reports
+
+struct TraceHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;      // File offset of the first record
+    uint32_t recordSize;
+    uint32_t flags;           // TRACE_FLAG_*
+    uint64_t startNs;         // MonotonicNanos() when recording began
+    uint64_t recordCount;
+    uint64_t droppedRecords;  // Lost because the writer fell behind
+    uint64_t indexOffset;
+    uint64_t indexCount;
+};
+
+struct TraceMouse {
+    int32_t x;
+    int32_t y;
+    int32_t wheel;
+    int32_t hwheel;
+    uint8_t buttons;
+};
+
+// Keyboards are stored as the usage bitmap whatever the report format
+struct TraceKeyboard {
+    uint64_t keys[4];
+};
+
+struct TraceGamepad {
+    int16_t sticks[4];
+    uint16_t triggers[2];
+    uint32_t buttons;
+    uint8_t hat;
+};
+
+struct TraceRecord {
+    uint64_t captureNs;   // Report timestamp
+    uint64_t dequeueNs;   // When the processing thread took it
+    uint32_t sequence;
+    uint16_t device;
+    uint8_t type;         // HIDReportType
+    uint8_t reserved;
+    union {
+        TraceMouse mouse;
+        TraceKeyboard keyboard;
+        TraceGamepad gamepad;
+        uint8_t payload[40];
+    };
+};
+
+// First record of every block, for seeking by time without a scan
+struct TraceIndexEntry {
+    uint64_t captureNs;
+    uint64_t recordIndex;
+};
+
+static_assert(sizeof(TraceHeader) <= TRACE_HEADER_SIZE);
+static_assert(sizeof(TraceRecord) == 64, "one record per cache line");
+static_assert(TRACE_HEADER_SIZE % sizeof(TraceRecord) == 0);
+static_assert(sizeof(TraceIndexEntry) == 16);
+
+// Report <-> record. Encoders fill every byte so records are reproducible.
+inline void EncodeTraceRecord(const MouseReport& report, uint64_t dequeueNs, TraceRecord& out) {
+    memset(&out, 0, sizeof(out));
+    out.captureNs = report.timestamp;
+    out.dequeueNs = dequeueNs;
+    out.sequence = report.sequence;
+    out.device = report.device;
+    out.type = static_cast<uint8_t>(HIDReportType::MOUSE);
+    out.mouse.x = report.x;
+    out.mouse.y = report.y;
+    out.mouse.wheel = report.wheel;
+    out.mouse.hwheel = report.hwheel;
+    out.mouse.buttons = report.buttons;
+}
+
+// BootKeyboardReport or NkroKeyboardReport
+template <typename Report>
+inline void EncodeTraceRecord(const Report& report, uint64_t dequeueNs, TraceRecord& out) {
+    memset(&out, 0, sizeof(out));
+    out.captureNs = report.timestamp;
+    out.dequeueNs = dequeueNs;
+    out.sequence = report.sequence;
+    out.device = report.device;
+    out.type = static_cast<uint8_t>(HIDReportType::KEYBOARD);
+    KeyBitmap held = report.heldKeys();
+    memcpy(out.keyboard.keys, held.words, sizeof(out.keyboard.keys));
+}
+
+inline void EncodeTraceRecord(const GamepadReport& report, uint64_t dequeueNs, TraceRecord& out) {
+    memset(&out, 0, sizeof(out));
+    out.captureNs = report.timestamp;
+    out.dequeueNs = dequeueNs;
+    out.sequence = report.sequence;
+    out.device = report.device;
+    out.type = static_cast<uint8_t>(HIDReportType::GAMEPAD);
+    memcpy(out.gamepad.sticks, report.sticks, sizeof(out.gamepad.sticks));
+    memcpy(out.gamepad.triggers, report.triggers, sizeof(out.gamepad.triggers));
+    out.gamepad.buttons = report.buttons;
+    out.gamepad.hat = report.hat;
+}
+
+inline MouseReport DecodeTraceMouse(const TraceRecord& record) {
+    MouseReport report;
+    report.timestamp = record.captureNs;
+    report.sequence = record.sequence;
+    report.device = record.device;
+    report.x = record.mouse.x;
+    report.y = record.mouse.y;
+    report.wheel = record.mouse.wheel;
+    report.hwheel = record.mouse.hwheel;
+    report.buttons = record.mouse.buttons;
+    return report;
+}
+
+// Into either keyboard format; a boot report keeps the six lowest keys
+inline KeyboardReport DecodeTraceKeyboard(const TraceRecord& record) {
+    KeyboardReport report;
+    report.timestamp = record.captureNs;
+    report.sequence = record.sequence;
+    report.device = record.device;
+    KeyBitmap held;
+    memcpy(held.words, record.keyboard.keys, sizeof(held.words));
+    report.setHeldKeys(held);
+    return report;
+}
+
+inline GamepadReport DecodeTraceGamepad(const TraceRecord& record) {
+    GamepadReport report;
+    report.timestamp = record.captureNs;
+    report.sequence = record.sequence;
+    report.device = record.device;
+    memcpy(report.sticks, record.gamepad.sticks, sizeof(report.sticks));
+    memcpy(report.triggers, record.gamepad.triggers, sizeof(report.triggers));
+    report.buttons = record.gamepad.buttons;
+    report.hat = record.gamepad.hat;
+    return report;
+}
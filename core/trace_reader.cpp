@@ -0,0 +1,129 @@
+#include "trace_reader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+TraceReader::~TraceReader() {
+    close();
+}
+
+bool TraceReader::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER size;
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size)) {
+        std::cerr << "Failed to open " << path << ". Error: " << GetLastError() << std::endl;
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        return false;
+    }
+    m_fileHandle = file;
+    m_size = static_cast<size_t>(size.QuadPart);
+    if (m_size >= sizeof(TraceHeader)) {
+        m_mappingHandle = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (m_mappingHandle)
+            m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0) {
+        std::cerr << "Failed to open " << path << ": " << strerror(errno) << std::endl;
+        if (fd >= 0)
+            ::close(fd);
+        return false;
+    }
+    m_size = static_cast<size_t>(info.st_size);
+    if (m_size >= sizeof(TraceHeader)) {
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data != MAP_FAILED) {
+            m_data = static_cast<const uint8_t*>(data);
+            // Replay walks the records front to back
+            madvise(data, m_size, MADV_SEQUENTIAL);
+        }
+    }
+    ::close(fd);
+#endif
+
+    const TraceHeader* header = reinterpret_cast<const TraceHeader*>(m_data);
+    if (!m_data || memcmp(header->magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0 ||
+        header->version != TRACE_VERSION || header->recordSize != sizeof(TraceRecord) ||
+        header->headerSize != TRACE_HEADER_SIZE || m_size < TRACE_HEADER_SIZE) {
+        std::cerr << path << " is not a version " << TRACE_VERSION << " input trace" << std::endl;
+        close();
+        return false;
+    }
+
+    m_header = header;
+    m_records = reinterpret_cast<const TraceRecord*>(m_data + TRACE_HEADER_SIZE);
+    size_t available = (m_size - TRACE_HEADER_SIZE) / sizeof(TraceRecord);
+
+    if (complete()) {
+        m_recordCount = std::min<size_t>(header->recordCount, available);
+        size_t indexEnd = header->indexOffset + header->indexCount * sizeof(TraceIndexEntry);
+        if (header->indexOffset >= TRACE_HEADER_SIZE && indexEnd <= m_size) {
+            m_index = reinterpret_cast<const TraceIndexEntry*>(m_data + header->indexOffset);
+            m_indexCount = header->indexCount;
+        }
+    } else {
+        m_recordCount = available;
+    }
+    return true;
+}
+
+void TraceReader::close() {
+#ifdef _WIN32
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mappingHandle)
+        CloseHandle(m_mappingHandle);
+    if (m_fileHandle)
+        CloseHandle(m_fileHandle);
+    m_mappingHandle = nullptr;
+    m_fileHandle = nullptr;
+#else
+    if (m_data)
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_header = nullptr;
+    m_records = nullptr;
+    m_recordCount = 0;
+    m_index = nullptr;
+    m_indexCount = 0;
+}
+
+size_t TraceReader::seek(uint64_t captureNs) const {
+    if (m_indexCount == 0) {
+        const TraceRecord* end = m_records + m_recordCount;
+        return static_cast<size_t>(std::partition_point(m_records, end, [&](const TraceRecord& record) {
+                                       return record.captureNs < captureNs;
+                                   }) - m_records);
+    }
+
+    // Last block starting before captureNs, then scan from there
+    const TraceIndexEntry* entry = std::partition_point(
+        m_index, m_index + m_indexCount,
+        [&](const TraceIndexEntry& candidate) { return candidate.captureNs < captureNs; });
+    size_t start = entry == m_index ? 0 : static_cast<size_t>(entry[-1].recordIndex);
+    for (size_t i = start; i < m_recordCount; i++) {
+        if (m_records[i].captureNs >= captureNs)
+            return i;
+    }
+    return m_recordCount;
+}
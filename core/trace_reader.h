@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#include "trace_format.h"
+
+// Read-only view of a trace file, mapped into memory so records are used
+// in place and a multi-hour trace costs only the pages actually touched.
+// Traces left without a final header (the recorder was killed) are read
+// up to the last whole record, without an index.
+class TraceReader {
+public:
+    TraceReader() = default;
+    ~TraceReader();
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    const TraceHeader& header() const { return *m_header; }
+    bool complete() const { return (m_header->flags & TRACE_FLAG_COMPLETE) != 0; }
+
+    const TraceRecord* records() const { return m_records; }
+    size_t recordCount() const { return m_recordCount; }
+
+    // Index of the first record captured at or after captureNs, or
+    // recordCount() if there is none. Uses the index when present and scans
+    // at most one block; capture times are only ordered within a device, so
+    // this is the first such record in dequeue order.
+    size_t seek(uint64_t captureNs) const;
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    const TraceHeader* m_header = nullptr;
+    const TraceRecord* m_records = nullptr;
+    size_t m_recordCount = 0;
+    const TraceIndexEntry* m_index = nullptr;
+    size_t m_indexCount = 0;
+#ifdef _WIN32
+    void* m_fileHandle = nullptr;
+    void* m_mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,146 @@
+#include "trace_recorder.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include "clock.h"
+
+namespace {
+
+// Upper bound on a parked wait so close() stays responsive
+constexpr auto IDLE_WAIT_TIMEOUT = std::chrono::milliseconds(100);
+
+}  // namespace
+
+TraceRecorder::TraceRecorder(std::string path) : m_path(std::move(path)) {}
+
+TraceRecorder::~TraceRecorder() {
+    close();
+}
+
+bool TraceRecorder::open() {
+    m_file = std::fopen(m_path.c_str(), "wb");
+    if (!m_file) {
+        std::cerr << "Failed to open " << m_path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Unbuffered, so each block reaches the file in a single write
+    std::setvbuf(m_file, nullptr, _IONBF, 0);
+
+    // Provisional header; readers fall back to the file size until close()
+    // rewrites it
+    m_startNs = MonotonicNanos();
+    if (!writeHeader(0)) {
+        std::cerr << "Failed to write " << m_path << ": " << strerror(errno) << std::endl;
+        std::fclose(m_file);
+        m_file = nullptr;
+        return false;
+    }
+
+    // Value-initialised, so every page is touched here rather than on the
+    // processing thread's first pass through the pool
+    m_blocks = std::make_unique<Block[]>(BLOCK_COUNT);
+    for (size_t i = 0; i < BLOCK_COUNT; i++)
+        m_freeBlocks.push(&m_blocks[i]);
+    m_index.reserve(1024);
+
+    m_stop.store(false, std::memory_order_relaxed);
+    m_thread = std::thread(&TraceRecorder::run, this);
+    return true;
+}
+
+void TraceRecorder::close() {
+    if (!m_thread.joinable())
+        return;
+
+    // The processing thread is done, so its partial block can go from here
+    if (m_current && m_current->count > 0)
+        submitBlock();
+
+    m_stop.store(true, std::memory_order_release);
+    m_wake.notify();
+    m_thread.join();
+
+    uint64_t count = recordCount();
+    bool complete = !m_writeFailed.load(std::memory_order_relaxed) &&
+                    std::fwrite(m_index.data(), sizeof(TraceIndexEntry), m_index.size(), m_file) ==
+                        m_index.size();
+    if (!complete || !writeHeader(TRACE_FLAG_COMPLETE))
+        std::cerr << "Trace " << m_path << " left incomplete (" << count << " records readable)" << std::endl;
+
+    std::fclose(m_file);
+    m_file = nullptr;
+    m_current = nullptr;
+}
+
+bool TraceRecorder::acquireBlock() {
+    if (!m_freeBlocks.pop(m_current))
+        return false;
+    m_current->count = 0;
+    return true;
+}
+
+void TraceRecorder::submitBlock() {
+    // Never fails: a block only leaves the free ring to come back here
+    m_fullBlocks.push(m_current);
+    m_current = nullptr;
+    m_wake.notify();
+}
+
+void TraceRecorder::run() {
+    Block* block;
+    while (true) {
+        bool stopping = m_stop.load(std::memory_order_acquire);
+
+        while (m_fullBlocks.pop(block)) {
+            uint64_t first = recordCount();
+            if (!m_writeFailed.load(std::memory_order_relaxed)) {
+                if (std::fwrite(block->records, sizeof(TraceRecord), block->count, m_file) == block->count) {
+                    m_index.push_back({block->records[0].captureNs, first});
+                    m_recordCount.store(first + block->count, std::memory_order_relaxed);
+                } else {
+                    std::cerr << "Failed to write " << m_path << ": " << strerror(errno)
+                              << "; recording stopped" << std::endl;
+                    m_writeFailed.store(true, std::memory_order_relaxed);
+                }
+            }
+            if (m_writeFailed.load(std::memory_order_relaxed))
+                m_droppedRecords.fetch_add(block->count, std::memory_order_relaxed);
+            m_freeBlocks.push(block);
+        }
+
+        if (stopping)
+            break;
+
+        m_wake.wait(WaitMode::BLOCK, std::chrono::nanoseconds(0), IDLE_WAIT_TIMEOUT, [&] {
+            return !m_fullBlocks.isEmpty() || m_stop.load(std::memory_order_relaxed);
+        });
+    }
+}
+
+bool TraceRecorder::writeHeader(uint32_t flags) {
+    uint8_t page[TRACE_HEADER_SIZE] = {};
+    TraceHeader header{};
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    header.headerSize = TRACE_HEADER_SIZE;
+    header.recordSize = sizeof(TraceRecord);
+#ifdef HID_NKRO_REPORTS
+    flags |= TRACE_FLAG_NKRO;
+#endif
+    header.flags = flags;
+    header.startNs = m_startNs;
+    header.recordCount = recordCount();
+    header.droppedRecords = droppedRecords();
+    if (flags & TRACE_FLAG_COMPLETE) {
+        header.indexOffset = TRACE_HEADER_SIZE + header.recordCount * sizeof(TraceRecord);
+        header.indexCount = m_index.size();
+    }
+    memcpy(page, &header, sizeof(header));
+
+    // The final header goes back over the provisional one
+    return std::fseek(m_file, 0, SEEK_SET) == 0 && std::fwrite(page, sizeof(page), 1, m_file) == 1 &&
+           std::fseek(m_file, 0, SEEK_END) == 0;
+}
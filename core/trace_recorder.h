@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "spsc_ring.h"
+#include "trace_format.h"
+#include "wake_signal.h"
+
+// Streams every dequeued report to a trace file (see trace_format.h).
+//
+// The processing thread encodes each report into a preallocated block and
+// hands full blocks to a writer thread, which appends each one with a
+// single 256 KiB write. Blocks are recycled through a pair of rings, so
+// recording never allocates, locks or makes a syscall on the processing
+// thread. If the writer falls a whole pool behind, records are dropped
+// and counted rather than waited for.
+class TraceRecorder {
+public:
+    static constexpr size_t BLOCK_COUNT = 8;
+
+    explicit TraceRecorder(std::string path);
+    ~TraceRecorder();
+
+    // Creates the file and starts the writer thread
+    bool open();
+    // Call once record() can no longer run: writes the last partial block,
+    // the index and the final header
+    void close();
+
+    // Processing thread only
+    template <typename Report>
+    void record(const Report& report, uint64_t dequeueNs) {
+        if (!m_current && !acquireBlock()) {
+            m_droppedRecords.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        EncodeTraceRecord(report, dequeueNs, m_current->records[m_current->count++]);
+        if (m_current->count == TRACE_RECORDS_PER_BLOCK)
+            submitBlock();
+    }
+
+    const std::string& path() const { return m_path; }
+    uint64_t recordCount() const { return m_recordCount.load(std::memory_order_relaxed); }
+    uint64_t droppedRecords() const { return m_droppedRecords.load(std::memory_order_relaxed); }
+
+private:
+    struct Block {
+        size_t count;
+        TraceRecord records[TRACE_RECORDS_PER_BLOCK];
+    };
+
+    bool acquireBlock();
+    void submitBlock();
+    void run();
+    bool writeHeader(uint32_t flags);
+
+    std::string m_path;
+    std::FILE* m_file = nullptr;
+    uint64_t m_startNs = 0;
+
+    // Processing thread -> writer and back
+    std::unique_ptr<Block[]> m_blocks;
+    SpscRing<Block*, BLOCK_COUNT> m_fullBlocks;
+    SpscRing<Block*, BLOCK_COUNT> m_freeBlocks;
+    Block* m_current = nullptr;  // Being filled by the processing thread
+    WakeSignal m_wake;
+
+    std::thread m_thread;
+    std::atomic<bool> m_stop{false};
+    std::atomic<bool> m_writeFailed{false};
+
+    // Written by the writer thread only
+    std::vector<TraceIndexEntry> m_index;
+    std::atomic<uint64_t> m_recordCount{0};
+
+    // Records with no free block, plus blocks lost to a failed write
+    std::atomic<uint64_t> m_droppedRecords{0};
+};
@@ -0,0 +1,129 @@
+#include "trace_replay.h"
+
+#include <cerrno>
+
+#include "clock.h"
+#include "input_pipeline.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace {
+
+// Long gaps in a trace are slept in slices this size so stop() is prompt
+constexpr uint64_t STOP_CHECK_NS = 100000000;
+
+}  // namespace
+
+void SleepUntil(uint64_t deadlineNs, uint64_t spinNs) {
+    uint64_t now = MonotonicNanos();
+    if (deadlineNs > now + spinNs) {
+        uint64_t wakeNs = deadlineNs - spinNs;
+#ifdef _WIN32
+        // No absolute sleep here; Sleep rounds to the system timer period,
+        // which the spin only partly covers
+        DWORD milliseconds = static_cast<DWORD>((wakeNs - now) / 1000000);
+        if (milliseconds > 0)
+            Sleep(milliseconds);
+#else
+        // MonotonicNanos() is CLOCK_MONOTONIC, so the deadline carries over as is
+        timespec wake;
+        wake.tv_sec = static_cast<time_t>(wakeNs / 1000000000);
+        wake.tv_nsec = static_cast<long>(wakeNs % 1000000000);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, nullptr) == EINTR) {}
+#endif
+    }
+
+    while (MonotonicNanos() < deadlineNs)
+        CpuRelax();
+}
+
+TraceReplaySource::TraceReplaySource(std::string path, double speed, std::chrono::nanoseconds spin)
+    : m_path(std::move(path)), m_speed(speed), m_spinNs(static_cast<uint64_t>(spin.count())) {}
+
+TraceReplaySource::~TraceReplaySource() {
+    stop();
+}
+
+bool TraceReplaySource::start(InputPipeline& pipeline) {
+    if (!m_reader.open(m_path))
+        return false;
+
+    m_pipeline = &pipeline;
+    m_stop = false;
+    m_finished = false;
+    m_lastSequence = 0;
+    m_thread = std::thread(&TraceReplaySource::run, this);
+    return true;
+}
+
+void TraceReplaySource::stop() {
+    m_stop = true;
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void TraceReplaySource::run() {
+    const TraceRecord* records = m_reader.records();
+    size_t count = m_reader.recordCount();
+    bool paced = m_speed > 0.0;
+
+    uint64_t traceStartNs = count > 0 ? records[0].captureNs : 0;
+    uint64_t replayStartNs = MonotonicNanos();
+
+    for (size_t i = 0; i < count && !m_stop.load(std::memory_order_relaxed); i++) {
+        const TraceRecord& record = records[i];
+        uint64_t deadlineNs = replayStartNs;
+
+        if (paced) {
+            // Capture times are only ordered per device; a report stamped
+            // before its predecessor goes out right away
+            uint64_t offsetNs = record.captureNs > traceStartNs ? record.captureNs - traceStartNs : 0;
+            deadlineNs += static_cast<uint64_t>(static_cast<double>(offsetNs) / m_speed);
+
+            uint64_t now = MonotonicNanos();
+            while (deadlineNs > now + m_spinNs + STOP_CHECK_NS && !m_stop.load(std::memory_order_relaxed)) {
+                SleepUntil(now + STOP_CHECK_NS, 0);
+                now = MonotonicNanos();
+            }
+            SleepUntil(deadlineNs, m_spinNs);
+        }
+
+        uint64_t pushNs = MonotonicNanos();
+        if (paced)
+            m_lateness.record(pushNs - deadlineNs);
+        m_lastSequence.store(push(record, pushNs), std::memory_order_release);
+        m_replayedCount.store(i + 1, std::memory_order_relaxed);
+    }
+
+    m_finished.store(true, std::memory_order_release);
+}
+
+uint32_t TraceReplaySource::push(const TraceRecord& record, uint64_t captureNs) {
+    switch (static_cast<HIDReportType>(record.type)) {
+        case HIDReportType::MOUSE: {
+            MouseReport report = DecodeTraceMouse(record);
+            report.timestamp = captureNs;
+            m_pipeline->pushMouse(report);
+            return report.sequence;
+        }
+        case HIDReportType::KEYBOARD: {
+            KeyboardReport report = DecodeTraceKeyboard(record);
+            report.timestamp = captureNs;
+            m_pipeline->pushKeyboard(report);
+            return report.sequence;
+        }
+        case HIDReportType::GAMEPAD: {
+            GamepadReport report = DecodeTraceGamepad(record);
+            report.timestamp = captureNs;
+            m_pipeline->pushGamepad(report);
+            return report.sequence;
+        }
+    }
+
+    // Unknown record types are skipped
+    return m_lastSequence.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "input_backend.h"
+#include "latency_histogram.h"
+#include "trace_reader.h"
+
+// Below this much time to a deadline the replay thread spins instead of
+// sleeping, to hide timer slack and wakeup latency
+constexpr auto DEFAULT_REPLAY_SPIN = std::chrono::microseconds(200);
+
+// Sleeps until deadlineNs on the MonotonicNanos() clock: an absolute-deadline
+// kernel sleep (clock_nanosleep TIMER_ABSTIME on Linux) to within spinNs of
+// it, then a spin for the rest. Returns at once if the deadline has passed.
+void SleepUntil(uint64_t deadlineNs, uint64_t spinNs);
+
+// Feeds a recorded trace (see trace_recorder.h) back into the pipeline as
+// if it were being captured, for reproducible load tests of the processing
+// thread and sinks.
+//
+// Each report is due at the trace start plus its original capture offset
+// divided by the speed, so timing errors never accumulate. Reports are
+// pushed with the time they were actually pushed as their capture time,
+// so the pipeline's latency histograms stay meaningful. At speed 0
+// (REPLAY_AS_FAST_AS_POSSIBLE) reports are pushed back to back, and the
+// queues' overload policies decide what survives.
+class TraceReplaySource : public InputSource {
+public:
+    static constexpr double REPLAY_AS_FAST_AS_POSSIBLE = 0.0;
+
+    explicit TraceReplaySource(std::string path, double speed = 1.0,
+                               std::chrono::nanoseconds spin = DEFAULT_REPLAY_SPIN);
+    ~TraceReplaySource() override;
+
+    const char* name() const override { return "trace-replay"; }
+    bool start(InputPipeline& pipeline) override;
+    void stop() override;
+
+    // Set once every record has been pushed
+    bool finished() const { return m_finished.load(std::memory_order_acquire); }
+    uint64_t replayedCount() const { return m_replayedCount.load(std::memory_order_relaxed); }
+    // Pipeline sequence of the newest report pushed, 0 before the first
+    uint32_t lastPushedSequence() const { return m_lastSequence.load(std::memory_order_acquire); }
+    size_t recordCount() const { return m_reader.recordCount(); }
+
+    // How far past its deadline each report was pushed
+    const LatencyHistogram& lateness() const { return m_lateness; }
+
+private:
+    void run();
+    // Returns the sequence the pipeline gave the report
+    uint32_t push(const TraceRecord& record, uint64_t captureNs);
+
+    std::string m_path;
+    double m_speed;
+    uint64_t m_spinNs;
+
+    TraceReader m_reader;
+    InputPipeline* m_pipeline = nullptr;
+    std::thread m_thread;
+    std::atomic<bool> m_stop{false};
+    std::atomic<bool> m_finished{false};
+    std::atomic<uint64_t> m_replayedCount{0};
+    std::atomic<uint32_t> m_lastSequence{0};
+    LatencyHistogram m_lateness;
+};
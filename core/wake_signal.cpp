@@ -0,0 +1,53 @@
+#include "wake_signal.h"
+
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "Synchronization.lib")
+#endif
+#else
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+bool ParseWaitMode(const char* text, WaitMode& mode) {
+    if (strcmp(text, "poll") == 0) mode = WaitMode::POLL;
+    else if (strcmp(text, "spin") == 0) mode = WaitMode::SPIN;
+    else if (strcmp(text, "block") == 0) mode = WaitMode::BLOCK;
+    else if (strcmp(text, "hybrid") == 0) mode = WaitMode::HYBRID;
+    else return false;
+    return true;
+}
+
+const char* WaitModeName(WaitMode mode) {
+    switch (mode) {
+        case WaitMode::POLL:   return "poll";
+        case WaitMode::SPIN:   return "spin";
+        case WaitMode::BLOCK:  return "block";
+        case WaitMode::HYBRID: return "hybrid";
+    }
+    return "unknown";
+}
+
+void WakeSignal::wakeWaiter() {
+#ifdef _WIN32
+    WakeByAddressSingle(&m_epoch);
+#else
+    syscall(SYS_futex, &m_epoch, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#endif
+}
+
+void WakeSignal::waitForEpochChange(uint32_t epoch, std::chrono::milliseconds timeout) {
+#ifdef _WIN32
+    WaitOnAddress(&m_epoch, &epoch, sizeof(epoch), static_cast<DWORD>(timeout.count()));
+#else
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+    ts.tv_nsec = static_cast<long>((timeout.count() % 1000) * 1000000);
+    syscall(SYS_futex, &m_epoch, FUTEX_WAIT_PRIVATE, epoch, &ts, nullptr, 0);
+#endif
+}
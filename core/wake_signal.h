@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+#include <thread>
+
+#include "hid_reports.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// How the processing thread waits when the queues are empty
+enum class WaitMode : uint8_t {
+    POLL,    // Sleep(POLLING_INTERVAL_MS) between checks (original behavior)
+    SPIN,    // Busy-wait, lowest latency, burns a core
+    BLOCK,   // Park on the wake signal immediately
+    HYBRID   // Spin for a budget, then park
+};
+
+constexpr auto DEFAULT_SPIN_BUDGET = std::chrono::microseconds(50);
+
+// Parses "poll", "spin", "block" or "hybrid"; returns false if unknown
+bool ParseWaitMode(const char* text, WaitMode& mode);
+const char* WaitModeName(WaitMode mode);
+
+inline void CpuRelax() {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Eventcount-style wakeup for a single consumer. The consumer announces that
+// it is about to park and re-checks for work before blocking; producers only
+// make the wake syscall when a consumer is actually parked, which only
+// happens once every queue has been seen empty. Blocks on a futex (Linux)
+// or WaitOnAddress (Windows).
+class WakeSignal {
+public:
+    // Producer side, call after the work item is published
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_waiting.load(std::memory_order_relaxed) != 0) {
+            m_epoch.fetch_add(1, std::memory_order_release);
+            wakeWaiter();
+        }
+    }
+
+    // Consumer side. Waits until ready() is true or the timeout elapses;
+    // returns ready().
+    template <typename Ready>
+    bool wait(WaitMode mode, std::chrono::nanoseconds spinBudget,
+              std::chrono::milliseconds timeout, Ready&& ready) {
+        if (mode == WaitMode::POLL) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(POLLING_INTERVAL_MS));
+            return ready();
+        }
+
+        if (mode == WaitMode::SPIN || mode == WaitMode::HYBRID) {
+            auto spinEnd = std::chrono::steady_clock::now() +
+                           (mode == WaitMode::SPIN ? std::chrono::nanoseconds(timeout) : spinBudget);
+            do {
+                for (int i = 0; i < 64; i++) {
+                    if (ready()) return true;
+                    CpuRelax();
+                }
+            } while (std::chrono::steady_clock::now() < spinEnd);
+
+            if (mode == WaitMode::SPIN)
+                return ready();
+        }
+
+        // Announce the park, then re-check so a concurrent notify is not lost
+        uint32_t epoch = m_epoch.load(std::memory_order_acquire);
+        m_waiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (!ready())
+            waitForEpochChange(epoch, timeout);
+
+        m_waiting.store(0, std::memory_order_relaxed);
+        return ready();
+    }
+
+private:
+    void wakeWaiter();
+    void waitForEpochChange(uint32_t epoch, std::chrono::milliseconds timeout);
+
+    alignas(64) std::atomic<uint32_t> m_epoch{0};
+    std::atomic<uint32_t> m_waiting{0};
+};
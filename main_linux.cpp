@@ -0,0 +1,259 @@
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/hid_file_sink.h"
+#include "core/input_pipeline.h"
+#include "core/mock_sink.h"
+#include "core/routing_sink.h"
+#include "core/trace_recorder.h"
+#include "core/trace_replay.h"
+#include "backends/linux/evdev_source.h"
+#include "backends/linux/uhid_sink.h"
+#include "backends/linux/uinput_gamepad_sink.h"
+#include "backends/linux/uinput_sink.h"
+
+// Global state
+InputPipeline g_pipeline;
+
+void HandleSignal(int) {
+    g_pipeline.running = false;
+}
+
+// Display help
+void DisplayHelp() {
+    std::cout << "\n=== Optimized HID Loopback Controls ===\n";
+    std::cout << "F12: Toggle input blocking (currently " << (g_pipeline.blockFeedback ? "ON" : "OFF") << ")\n";
+    std::cout << "F11: Toggle performance monitor (currently " << (g_pipeline.enableProfiling ? "ON" : "OFF") << ")\n";
+    std::cout << "ESC / Ctrl+C: Exit program\n";
+    std::cout << "======================================\n\n";
+}
+
+void DisplayUsage(const char* program) {
+    std::cout << "Usage: " << program << " [--mock | --uhid | --hid-file=PATH] [--wait=MODE] [--spin-us=N]"
+              << " [--batch-max=N] [--batch-budget-us=N] [--record=PATH]"
+              << " [--replay=PATH [--replay-speed=N|max] [--replay-spin-us=N]] [/dev/input/eventN ...]\n"
+              << "  --mock          Use the in-memory sink instead of /dev/uinput\n"
+              << "  --uhid          Inject through one composite HID device on /dev/uhid\n"
+              << "  --hid-file=PATH Write the composite device's HID reports to PATH\n"
+              << "  --wait=MODE     Idle wait: poll, spin, block or hybrid (default)\n"
+              << "  --spin-us=N     Spin budget before parking in hybrid mode\n"
+              << "  --batch-max=N   Most events per injection call under bursts (default 256)\n"
+              << "  --batch-budget-us=N  Flush a batch once its oldest event is this old (default 250)\n"
+              << "  --record=PATH   Write every captured report to a trace file at PATH\n"
+              << "  --replay=PATH   Feed a recorded trace through the pipeline instead of evdev,\n"
+              << "                  exiting once it has been injected\n"
+              << "  --replay-speed=N  Replay at N (> 0) times the recorded pace, or max for no pacing\n"
+              << "  --replay-spin-us=N  Spin this long before each replayed report (default 200)\n"
+              << "  With no device paths every mouse, keyboard and gamepad is captured.\n";
+}
+
+// "max" or a finite speed above 0; false on anything else
+bool ParseReplaySpeed(const char* text, double& speed) {
+    if (strcmp(text, "max") == 0) {
+        speed = TraceReplaySource::REPLAY_AS_FAST_AS_POSSIBLE;
+        return true;
+    }
+    char* end = nullptr;
+    errno = 0;
+    double value = strtod(text, &end);
+    if (end == text || *end != '\0' || errno != 0 || !std::isfinite(value) || value <= 0.0)
+        return false;
+    speed = value;
+    return true;
+}
+
+// A whole number of microseconds, 0 or more; false on anything else
+bool ParseMicroseconds(const char* text, std::chrono::nanoseconds& duration) {
+    char* end = nullptr;
+    errno = 0;
+    long long value = strtoll(text, &end, 10);
+    if (end == text || *end != '\0' || errno != 0 || value < 0 ||
+        value > std::chrono::nanoseconds::max().count() / 1000)
+        return false;
+    duration = std::chrono::microseconds(value);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool useMock = false;
+    bool useUhid = false;
+    std::string hidFilePath;
+    std::string recordPath;
+    std::string replayPath;
+    double replaySpeed = 1.0;
+    std::chrono::nanoseconds replaySpin = DEFAULT_REPLAY_SPIN;
+    std::vector<std::string> devicePaths;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--mock") == 0) {
+            useMock = true;
+        } else if (strcmp(argv[i], "--uhid") == 0) {
+            useUhid = true;
+        } else if (strncmp(argv[i], "--hid-file=", 11) == 0) {
+            hidFilePath = argv[i] + 11;
+        } else if (strncmp(argv[i], "--wait=", 7) == 0) {
+            if (!ParseWaitMode(argv[i] + 7, g_pipeline.waitMode)) {
+                DisplayUsage(argv[0]);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--spin-us=", 10) == 0) {
+            g_pipeline.spinBudget = std::chrono::microseconds(atoi(argv[i] + 10));
+        } else if (strncmp(argv[i], "--batch-max=", 12) == 0) {
+            g_pipeline.batchPolicy.maxEvents = static_cast<size_t>(atoi(argv[i] + 12));
+        } else if (strncmp(argv[i], "--batch-budget-us=", 18) == 0) {
+            g_pipeline.batchPolicy.latencyBudget = std::chrono::microseconds(atoi(argv[i] + 18));
+        } else if (strncmp(argv[i], "--record=", 9) == 0) {
+            recordPath = argv[i] + 9;
+        } else if (strncmp(argv[i], "--replay=", 9) == 0) {
+            replayPath = argv[i] + 9;
+        } else if (strncmp(argv[i], "--replay-speed=", 15) == 0) {
+            if (!ParseReplaySpeed(argv[i] + 15, replaySpeed)) {
+                DisplayUsage(argv[0]);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--replay-spin-us=", 17) == 0) {
+            if (!ParseMicroseconds(argv[i] + 17, replaySpin)) {
+                DisplayUsage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            DisplayUsage(argv[0]);
+            return 0;
+        } else {
+            devicePaths.push_back(argv[i]);
+        }
+    }
+
+    std::cout << "=== High-Performance HID Loopback ===\n";
+    std::cout << "This program offers optimized input redirection\n";
+
+    std::signal(SIGINT, HandleSignal);
+    std::signal(SIGTERM, HandleSignal);
+
+    // Fall back to the in-memory sink when uinput is unavailable
+    std::unique_ptr<InputSink> sink;
+    if (!useMock) {
+        if (!hidFilePath.empty())
+            sink.reset(new HidFileSink(hidFilePath));
+        else if (useUhid)
+            sink.reset(new UhidSink());
+        else
+            sink.reset(new UinputSink());
+        if (!sink->open()) {
+            std::cerr << "Falling back to the mock sink." << std::endl;
+            useMock = true;
+        }
+    }
+    if (useMock) {
+        sink.reset(new MockSink(false));
+        sink->open();
+    }
+
+    // Under uinput, gamepad events get their own virtual device; without it
+    // they are dropped. The HID report sinks carry the gamepad themselves.
+    std::unique_ptr<InputSink> gamepadSink;
+    std::unique_ptr<InputSink> routingSink;
+    InputSink* output = sink.get();
+    if (!useMock && !useUhid && hidFilePath.empty()) {
+        gamepadSink.reset(new UinputGamepadSink());
+        if (gamepadSink->open()) {
+            routingSink.reset(new RoutingSink(*sink, *gamepadSink));
+            output = routingSink.get();
+        } else {
+            std::cerr << "Gamepad injection disabled." << std::endl;
+            gamepadSink.reset();
+        }
+    }
+
+    // The uinput device exists by now, so autodetection can skip it. A
+    // replay is started once the processing thread is running.
+    std::unique_ptr<InputSource> source;
+    TraceReplaySource* replay = nullptr;
+    if (replayPath.empty()) {
+        source.reset(new EvdevSource(devicePaths));
+        if (!source->start(g_pipeline)) {
+            std::cerr << "Failed to initialize. Exiting." << std::endl;
+            return 1;
+        }
+    } else {
+        replay = new TraceReplaySource(replayPath, replaySpeed, replaySpin);
+        source.reset(replay);
+    }
+
+    std::cout << "Injecting through the " << sink->name()
+              << (gamepadSink ? " and uinput-gamepad" : "") << " sink, "
+              << WaitModeName(g_pipeline.waitMode) << " wait, "
+              << KEYBOARD_REPORT_FORMAT << " keyboard reports\n";
+    DisplayHelp();
+
+    // Record every dequeued report when asked to
+    std::unique_ptr<TraceRecorder> recorder;
+    if (!recordPath.empty()) {
+        recorder.reset(new TraceRecorder(recordPath));
+        if (recorder->open()) {
+            g_pipeline.recorder = recorder.get();
+        } else {
+            std::cerr << "Recording disabled." << std::endl;
+            recorder.reset();
+        }
+    }
+
+    // From here on runtime messages go through the logger thread
+    g_pipeline.logger.start(std::cout);
+
+    // Start input processing thread
+    std::thread processThread(ProcessInputEvents, std::ref(g_pipeline), std::ref(*output));
+
+    if (replay && !replay->start(g_pipeline)) {
+        std::cerr << "Failed to start the replay. Exiting." << std::endl;
+        g_pipeline.running = false;
+    }
+
+    while (g_pipeline.running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        // A replay ends the run once the processing thread has sent everything
+        // it pushed, including reports held back by the ordered drain
+        if (replay && replay->finished() &&
+            !SequenceBefore(g_pipeline.sentSequence.load(std::memory_order_acquire),
+                            replay->lastPushedSequence())) {
+            g_pipeline.running = false;
+            g_pipeline.wakeSignal.notify();
+        }
+    }
+
+    // Cleanup
+    source->stop();
+
+    // Wait for processing thread to finish
+    if (processThread.joinable()) {
+        processThread.join();
+    }
+    g_pipeline.logger.stop();
+    if (recorder) {
+        recorder->close();
+        std::cout << "Recorded " << recorder->recordCount() << " reports to " << recorder->path()
+                  << " (" << recorder->droppedRecords() << " dropped)\n";
+    }
+
+    output->close();
+
+    if (replay) {
+        std::cout << "Replayed " << replay->replayedCount() << " of " << replay->recordCount()
+                  << " reports from " << replayPath << "\n";
+        PrintLatency(std::cout, "Replay lateness", replay->lateness());
+    }
+    g_pipeline.latency.print(std::cout);
+    std::cout << "HID loopback terminated." << std::endl;
+    return 0;
+}